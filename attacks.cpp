@@ -105,7 +105,7 @@ U64 Attacks::getRookAttacksRays(int sq, U64 blockers)
     // north attacks
     U64 rookAttacksNorth = Rays::getRay(NORTH, sq);
     U64 northBlocker = rookAttacksNorth & blockers;
-    if(blockers)
+    if(northBlocker)
     {
         int index = bitScanForward(northBlocker);
         rookAttacksNorth ^= Rays::getRay(NORTH, index);
@@ -115,7 +115,7 @@ U64 Attacks::getRookAttacksRays(int sq, U64 blockers)
     // south attacks
     U64 rookAttacksSouth = Rays::getRay(SOUTH, sq);
     U64 southBlocker = rookAttacksSouth & blockers;
-    if(blockers)
+    if(southBlocker)
     {
         int index = bitScanReverse(southBlocker);
         rookAttacksSouth ^= Rays::getRay(SOUTH, index);
@@ -125,7 +125,7 @@ U64 Attacks::getRookAttacksRays(int sq, U64 blockers)
     // east attacks
     U64 rookAttacksEast = Rays::getRay(EAST, sq);
     U64 eastBlocker = rookAttacksEast & blockers;
-    if(blockers)
+    if(eastBlocker)
     {
         int index = bitScanForward(eastBlocker);
         rookAttacksEast ^= Rays::getRay(EAST, index);
@@ -135,7 +135,7 @@ U64 Attacks::getRookAttacksRays(int sq, U64 blockers)
     // west attacks
     U64 rookAttacksWest = Rays::getRay(WEST, sq);
     U64 westBlocker = rookAttacksWest & blockers;
-    if(blockers)
+    if(westBlocker)
     {
         int index = bitScanReverse(westBlocker);
         rookAttacksWest ^= Rays::getRay(WEST, index);
@@ -152,7 +152,7 @@ U64 Attacks::getBishopAttacksRays(int sq, U64 blockers)
     // north west attacks
     U64 bishopAttacksNorthWest = Rays::getRay(NORTH_WEST, sq);
     U64 northWestBlocker = bishopAttacksNorthWest & blockers;
-    if(blockers)
+    if(northWestBlocker)
     {
         int index = bitScanForward(northWestBlocker);
         bishopAttacksNorthWest ^= Rays::getRay(NORTH_WEST, index);
@@ -169,7 +169,7 @@ U64 Attacks::getBishopAttacksRays(int sq, U64 blockers)
     // south east attacks
     U64 bishopAttacksSouthEast = Rays::getRay(SOUTH_EAST, sq);
     U64 southEastBlocker = bishopAttacksSouthEast & blockers;
-    if(blockers)
+    if(southEastBlocker)
     {
         int index = bitScanReverse(southEastBlocker);
         bishopAttacksSouthEast ^= Rays::getRay(SOUTH_EAST, index);
@@ -179,7 +179,7 @@ U64 Attacks::getBishopAttacksRays(int sq, U64 blockers)
     // south west attacks
     U64 bishopAttacksSouthWest = Rays::getRay(SOUTH_WEST, sq);
     U64 southWestBlocker = bishopAttacksSouthWest & blockers;
-    if(blockers)
+    if(southWestBlocker)
     {
         int index = bitScanReverse(southWestBlocker);
         bishopAttacksSouthWest ^= Rays::getRay(SOUTH_WEST, index);
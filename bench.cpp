@@ -0,0 +1,358 @@
+// Bench.cpp | Benchmarks for measuring the speed of the library.
+
+#include <bench.h>
+#include <board.h>
+#include <movegen.h>
+#include <search.h>
+#include <nnue.h>
+#include <simd.h>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstring>
+
+using namespace nnchesslib;
+
+// Well known perft positions: startpos, kiwipete, and positions 3 and 4 from the chessprogramming wiki.
+static const std::string benchFens[] = {
+    STARTING_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"
+};
+
+U64 Bench::perft(ChessBoard& board, int depth)
+{
+    MoveList moves = genLegalMoves(board);
+
+    // no need to push the moves on the last ply, every legal move is a leaf.
+    if(depth <= 1) return depth == 1 ? moves.size() : 1;
+
+    U64 nodes = 0;
+    for(auto move : moves)
+    {
+        board.pushMove(move);
+        nodes += perft(board, depth - 1);
+        board.popMove();
+    }
+    return nodes;
+}
+
+void Bench::runMovegenBench(int depth)
+{
+    U64 totalNodes = 0;
+    double totalSeconds = 0;
+
+    for(const std::string &fen : benchFens)
+    {
+        ChessBoard board(fen);
+
+        auto begin = std::chrono::steady_clock::now();
+        U64 nodes = perft(board, depth);
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - begin).count();
+        totalNodes += nodes;
+        totalSeconds += seconds;
+
+        std::cout << "perft " << depth << " " << nodes << " nodes " << seconds << "s " << fen << std::endl;
+    }
+
+    std::cout << "Total: " << totalNodes << " nodes in " << totalSeconds << "s, "
+              << (U64)(totalNodes / totalSeconds) << " nps" << std::endl;
+}
+
+void Bench::runSearchBench(int depth)
+{
+    U64 totalNodes = 0;
+    double totalSeconds = 0;
+
+    for(const std::string &fen : benchFens)
+    {
+        SearchLimits limits;
+        limits.depth = depth;
+
+        auto begin = std::chrono::steady_clock::now();
+        SearchResult result = Search::search(ChessBoard(fen), limits);
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - begin).count();
+        totalNodes += result.nodes;
+        totalSeconds += seconds;
+
+        std::cout << "depth " << result.depth << " bestmove " << toUci(result.bestMove) << " score " << result.score
+                  << " nodes " << result.nodes << " " << seconds << "s " << fen << std::endl;
+    }
+
+    std::cout << "Total: " << totalNodes << " nodes in " << totalSeconds << "s, "
+              << (U64)(totalNodes / totalSeconds) << " nps" << std::endl;
+}
+
+void Bench::runThreadBench(int depth)
+{
+    const int threadCounts[] = {1, 2, 4, 8, 16, 32, 64};
+    double singleThreadSeconds = 0;
+
+    for(int threads : threadCounts)
+    {
+        U64 totalNodes = 0;
+        double totalSeconds = 0;
+
+        for(const std::string &fen : benchFens)
+        {
+            // every run starts from an empty table, otherwise later runs would reuse earlier results.
+            Search::clearHash();
+
+            SearchLimits limits;
+            limits.depth = depth;
+            limits.threads = threads;
+
+            auto begin = std::chrono::steady_clock::now();
+            SearchResult result = Search::search(ChessBoard(fen), limits);
+            auto end = std::chrono::steady_clock::now();
+
+            totalNodes += result.nodes;
+            totalSeconds += std::chrono::duration<double>(end - begin).count();
+        }
+
+        if(threads == 1) singleThreadSeconds = totalSeconds;
+
+        std::cout << "threads " << threads << " time to depth " << depth << ": " << totalSeconds << "s, "
+                  << totalNodes << " nodes, " << (U64)(totalNodes / totalSeconds) << " nps, speedup "
+                  << singleThreadSeconds / totalSeconds << std::endl;
+    }
+}
+
+void Bench::runSelectiveBench(int depth)
+{
+    struct Variant
+    {
+        std::string name;
+        bool SearchOptions::* option;
+    };
+
+    const Variant variants[] = {
+        {"all", nullptr},
+        {"no null move pruning", &SearchOptions::nullMovePruning},
+        {"no late move reductions", &SearchOptions::lateMoveReductions},
+        {"no futility pruning", &SearchOptions::futilityPruning},
+        {"no reverse futility pruning", &SearchOptions::reverseFutilityPruning},
+        {"no late move pruning", &SearchOptions::lateMovePruning},
+        {"no check extensions", &SearchOptions::checkExtensions},
+        {"no singular extensions", &SearchOptions::singularExtensions},
+        {"none", nullptr}
+    };
+
+    for(const Variant &variant : variants)
+    {
+        SearchLimits limits;
+        limits.depth = depth;
+
+        if(variant.option)
+            limits.options.*variant.option = false;
+        else if(variant.name == "none")
+            limits.options = {false, false, false, false, false, false, false};
+
+        U64 totalNodes = 0;
+        double totalSeconds = 0;
+        std::string bestMoves;
+
+        for(const std::string &fen : benchFens)
+        {
+            Search::clearHash();
+
+            auto begin = std::chrono::steady_clock::now();
+            SearchResult result = Search::search(ChessBoard(fen), limits);
+            auto end = std::chrono::steady_clock::now();
+
+            totalNodes += result.nodes;
+            totalSeconds += std::chrono::duration<double>(end - begin).count();
+            bestMoves += " " + toUci(result.bestMove) + " (" + std::to_string(result.score) + ")";
+        }
+
+        std::cout << variant.name << ": " << totalNodes << " nodes, " << totalSeconds << "s," << bestMoves << std::endl;
+    }
+}
+
+void Bench::runMultiPVBench(int lines, int depth)
+{
+    for(const std::string &fen : benchFens)
+    {
+        std::cout << fen << std::endl;
+
+        SearchLimits limits;
+        limits.depth = depth;
+        limits.multiPV = lines;
+        limits.onIteration = [](const SearchResult& result)
+        {
+            for(size_t i = 0; i < result.lines.size(); i++)
+            {
+                std::cout << "depth " << result.depth << " multipv " << i + 1 << " score " << result.lines[i].score << " pv";
+                for(Move move : result.lines[i].pv)
+                    std::cout << " " << toUci(move);
+                std::cout << std::endl;
+            }
+        };
+
+        SearchResult result = Search::search(ChessBoard(fen), limits);
+        std::cout << "bestmove " << toUci(result.bestMove) << " nodes " << result.nodes << std::endl;
+    }
+}
+
+// Sums the evaluations of all positions in the move tree, pushing the moves keeps the accumulators up to date.
+static U64 evaluateTree(ChessBoard& board, int depth, U64& nodes)
+{
+    nodes++;
+    U64 sum = NNUE::evaluate(board);
+    if(depth == 0) return sum;
+
+    for(Move move : genLegalMoves(board))
+    {
+        board.pushMove(move);
+        sum = sum * 31 + evaluateTree(board, depth - 1, nodes);
+        board.popMove();
+    }
+    return sum;
+}
+
+void Bench::runNNUEBench(int depth)
+{
+    NNUE::Network network;
+    network.randomize(1);
+
+    Simd::Level detected = Simd::detectLevel();
+    U64 scalarChecksum = 0;
+
+    for(Simd::Level level : {Simd::SCALAR, Simd::SSE41, Simd::AVX2})
+    {
+        if(!Simd::setLevel(level))
+        {
+            std::cout << "kernel level " << level << " is not supported by this cpu" << std::endl;
+            continue;
+        }
+
+        U64 nodes = 0;
+        U64 checksum = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for(const std::string &fen : benchFens)
+        {
+            ChessBoard board(fen);
+            board.setNetwork(&network);
+            checksum = checksum * 31 + evaluateTree(board, depth, nodes);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - begin).count();
+
+        if(level == Simd::SCALAR) scalarChecksum = checksum;
+
+        std::cout << Simd::kernels().name << ": " << nodes << " evaluations in " << seconds << "s, "
+                  << (U64)(nodes / seconds) << " nps, checksum " << checksum
+                  << (checksum == scalarChecksum ? " (matches scalar)" : " (MISMATCH)") << std::endl;
+    }
+
+    Simd::setLevel(detected);
+}
+
+bool Bench::runKernelCheck(int rounds)
+{
+    // xorshift64*, the same generator as the zobrist keys.
+    U64 seed = 0x9E3779B97F4A7C15ULL;
+    auto next = [&seed]()
+    {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 2685821657736338717ULL;
+    };
+
+    // long enough for the layer inputs, the lengths and offsets are random so the tails and unaligned
+    // loads are covered as well.
+    const int MAX_LENGTH = 2 * NNUE::L1 + 31;
+    const int MAX_OFFSET = 16;
+    const int BUFFER = MAX_LENGTH + MAX_OFFSET;
+
+    const char * names[] = {"addRow", "subtractRow", "addSubtractRow", "clippedRelu", "dot", "expandBits", "expandBitsFloat"};
+    const int KERNEL_COUNT = sizeof(names) / sizeof(names[0]);
+
+    const Simd::Kernels& scalar = Simd::kernels(Simd::SCALAR);
+    bool passed = true;
+
+    for(Simd::Level level : {Simd::SSE41, Simd::AVX2})
+    {
+        if(!Simd::supported(level))
+        {
+            std::cout << "kernel level " << level << " is not supported by this cpu" << std::endl;
+            continue;
+        }
+
+        const Simd::Kernels& vector = Simd::kernels(level);
+        U64 mismatches[KERNEL_COUNT] = {};
+
+        for(int round = 0; round < rounds; round++)
+        {
+            alignas(64) int16_t values[BUFFER], expected[BUFFER], added[BUFFER], removed[BUFFER];
+            alignas(64) uint8_t input[BUFFER], output[BUFFER], expectedOutput[BUFFER];
+            alignas(64) int8_t weights[BUFFER];
+
+            for(int i = 0; i < BUFFER; i++)
+            {
+                values[i] = expected[i] = (int16_t)next();
+                added[i] = (int16_t)next();
+                removed[i] = (int16_t)next();
+                // the dot product expects clipped relu outputs.
+                input[i] = next() % 128;
+                weights[i] = (int8_t)next();
+            }
+
+            int length = next() % (MAX_LENGTH + 1);
+            int offset = next() % MAX_OFFSET;
+            int16_t * v = values + offset, * e = expected + offset;
+            int16_t * a = added + offset, * r = removed + offset;
+            size_t rowBytes = length * sizeof(int16_t);
+
+            scalar.addRow(e, a, length);
+            vector.addRow(v, a, length);
+            mismatches[0] += std::memcmp(v, e, rowBytes) != 0;
+
+            // every kernel starts from the same values, so a mismatch is only counted for the kernel that caused it.
+            std::memcpy(v, e, rowBytes);
+            scalar.subtractRow(e, r, length);
+            vector.subtractRow(v, r, length);
+            mismatches[1] += std::memcmp(v, e, rowBytes) != 0;
+
+            std::memcpy(v, e, rowBytes);
+            scalar.addSubtractRow(e, a, r, length);
+            vector.addSubtractRow(v, a, r, length);
+            mismatches[2] += std::memcmp(v, e, rowBytes) != 0;
+
+            scalar.clippedRelu(a, expectedOutput + offset, length);
+            vector.clippedRelu(a, output + offset, length);
+            mismatches[3] += std::memcmp(output + offset, expectedOutput + offset, length) != 0;
+
+            mismatches[4] += scalar.dot(input + offset, weights + offset, length)
+                != vector.dot(input + offset, weights + offset, length);
+
+            // sparse and dense bitboards, like the piece planes of a tensor.
+            U64 bits = next() & (round % 2 ? next() : ~(U64)0);
+            alignas(64) float planes[64], expectedPlanes[64];
+            scalar.expandBits(bits, expectedOutput);
+            vector.expandBits(bits, output);
+            mismatches[5] += std::memcmp(output, expectedOutput, 64) != 0;
+
+            scalar.expandBitsFloat(bits, expectedPlanes);
+            vector.expandBitsFloat(bits, planes);
+            mismatches[6] += std::memcmp(planes, expectedPlanes, sizeof(planes)) != 0;
+        }
+
+        std::cout << vector.name << ":";
+        for(int i = 0; i < KERNEL_COUNT; i++)
+        {
+            std::cout << " " << names[i] << " " << mismatches[i];
+            if(mismatches[i]) passed = false;
+        }
+        std::cout << " mismatches in " << rounds << " rounds" << std::endl;
+    }
+
+    std::cout << (passed ? "all kernels match scalar" : "KERNEL MISMATCH") << std::endl;
+    return passed;
+}
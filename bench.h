@@ -0,0 +1,39 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <board.h>
+
+namespace nnchesslib
+{
+    namespace Bench
+    {
+        // Counts the leaf nodes of the legal move tree up to a given depth.
+        U64 perft(ChessBoard& board, int depth);
+
+        // Runs perft on a set of positions and prints nodes per second.
+        void runMovegenBench(int depth);
+
+        // Searches a set of positions to a fixed depth and prints nodes, time and nodes per second.
+        void runSearchBench(int depth);
+
+        // Measures time-to-depth of the search with 1, 2, 4, ... 64 threads and prints the speedup over one thread.
+        void runThreadBench(int depth);
+
+        // Searches the bench positions with all selective search techniques, then with each one turned off
+        // and with all of them turned off, and prints the nodes and time needed to reach the depth.
+        void runSelectiveBench(int depth);
+
+        // Analyses the bench positions with several lines and prints every line of every iteration.
+        void runMultiPVBench(int lines, int depth);
+
+        // Walks the move tree of the bench positions with a randomized network and evaluates every node, once with
+        // every supported kernel level. Prints the speed of each level and whether its evaluations match the scalar ones.
+        void runNNUEBench(int depth);
+
+        // Runs every vector kernel of every supported level and the scalar kernel on the same random inputs, and
+        // prints how many results differ. Returns true when all of them match.
+        bool runKernelCheck(int rounds);
+    }
+}
+
+#endif
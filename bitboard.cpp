@@ -7,40 +7,12 @@
 
 using namespace nnchesslib;
 
-BitBoard::BitBoard()
-{
-    board = 0;
-}
-
-BitBoard::BitBoard(U64 value)
-{
-    board = value;
-}
-
 std::string BitBoard::getBoardString()
 {
     std::string binary = std::bitset<64>(board).to_string();
     return binary;
 }
 
-void BitBoard::set(int square, bool set)
-{
-    assert(0 <= square && square <= 63);
-    if(set)
-        board |= ((U64)1 << square);
-    else
-        board &= ~((U64)1 << square);
-}
-
-int BitBoard::get(int square)
-{
-    assert(0 <= square && square <= 63);
-    
-    int val = (board >> square) & 1;
-
-    return val;
-}
-
 void BitBoard::setRank(int y)
 {
     assert(0 <= y && y <= 7);
@@ -70,6 +42,20 @@ U64 BitBoard::flipVertical()
     return __bswap_64(BitBoard::board);
 }
 
+// Swaps files a-h, b-g, c-f and d-e by swapping bits, pairs and nibbles inside every byte.
+U64 BitBoard::mirrorHorizontal()
+{
+    const U64 k1 = 0x5555555555555555ULL;
+    const U64 k2 = 0x3333333333333333ULL;
+    const U64 k4 = 0x0f0f0f0f0f0f0f0fULL;
+
+    U64 x = BitBoard::board;
+    x = ((x >> 1) & k1) | ((x & k1) << 1);
+    x = ((x >> 2) & k2) | ((x & k2) << 2);
+    x = ((x >> 4) & k4) | ((x & k4) << 4);
+    return x;
+}
+
 void BitBoard::printDebug()
 {
     std::string boardString = getBoardString();
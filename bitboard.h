@@ -2,6 +2,7 @@
 #define BITBOARD_H
 
 #include <string>
+#include <cassert>
 #include <types.h>
 
 namespace nnchesslib
@@ -12,15 +13,27 @@ namespace nnchesslib
             //Attributes
             U64 board;
             //Constructors
-            BitBoard();
-            BitBoard(U64 value);
+            constexpr BitBoard() : board(0) {}
+            constexpr BitBoard(U64 value) : board(value) {}
 
             //IO
             std::string getBoardString();
 
             //Interact with individual points
-            void set(int square, bool set);
-            int get(int square);
+            constexpr inline void set(int square, bool set)
+            {
+                assert(0 <= square && square <= 63);
+                if(set)
+                    board |= ((U64)1 << square);
+                else
+                    board &= ~((U64)1 << square);
+            }
+
+            constexpr inline int get(int square) const
+            {
+                assert(0 <= square && square <= 63);
+                return (board >> square) & 1;
+            }
 
             //Interact with lines
             void setFile(int y);
@@ -32,7 +45,56 @@ namespace nnchesslib
 
             // Manipulate the board
             U64 flipVertical();
-            
+            U64 mirrorHorizontal();
+
+            //Operators, these take and return BitBoards by value so they compile to plain U64 instructions.
+            friend constexpr BitBoard operator&(BitBoard a, BitBoard b) { return a.board & b.board; }
+            friend constexpr BitBoard operator|(BitBoard a, BitBoard b) { return a.board | b.board; }
+            friend constexpr BitBoard operator^(BitBoard a, BitBoard b) { return a.board ^ b.board; }
+            constexpr BitBoard operator~() const { return ~board; }
+            constexpr BitBoard operator<<(int n) const { return board << n; }
+            constexpr BitBoard operator>>(int n) const { return board >> n; }
+
+            constexpr BitBoard& operator&=(BitBoard b) { board &= b.board; return *this; }
+            constexpr BitBoard& operator|=(BitBoard b) { board |= b.board; return *this; }
+            constexpr BitBoard& operator^=(BitBoard b) { board ^= b.board; return *this; }
+
+            constexpr bool operator==(BitBoard b) const { return board == b.board; }
+            constexpr bool operator!=(BitBoard b) const { return board != b.board; }
+
+            // True when at least one bit is set.
+            constexpr explicit operator bool() const { return board != 0; }
+
+            // Number of set bits.
+            constexpr int popcount() const { return __builtin_popcountll(board); }
+            // Index of the least significant set bit, the board must not be empty.
+            constexpr int lsb() const
+            {
+                assert(board);
+                return __builtin_ctzll(board);
+            }
+            // Returns the index of the least significant set bit and clears it.
+            constexpr int popLsb()
+            {
+                int index = lsb();
+                board &= board - 1;
+                return index;
+            }
+
+            // Iterates over the indices of the set bits from a1 to h8: for(int sq : board) {...}
+            class Iterator
+            {
+                public:
+                    U64 bits;
+
+                    constexpr int operator*() const { return __builtin_ctzll(bits); }
+                    constexpr Iterator& operator++() { bits &= bits - 1; return *this; }
+                    constexpr bool operator!=(const Iterator& other) const { return bits != other.bits; }
+            };
+
+            constexpr Iterator begin() const { return Iterator{board}; }
+            constexpr Iterator end() const { return Iterator{0}; }
+
             // Debug
             void printDebug();
     };
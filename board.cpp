@@ -11,6 +11,9 @@
 #include <attacks.h>
 #include <utils.h>
 #include <movegen.h>
+#include <zobrist.h>
+#include <tt.h>
+#include <evaluate.h>
 
 using namespace nnchesslib;
 
@@ -209,6 +212,10 @@ void ChessBoard::generateBitBoards(std::string fen)
     boardinfo.pawns = boardinfo.pawns.flipVertical();
     boardinfo.whitePieces = boardinfo.whitePieces.flipVertical();
     boardinfo.blackPieces = boardinfo.blackPieces.flipVertical();
+
+    boardinfo.key = computeKey(boardinfo);
+    boardinfo.pawnKey = computePawnKey(boardinfo);
+    Eval::refreshScores(boardinfo);
 }
 
 //function for printing / combining all the bitboards to form a readable board. 
@@ -217,28 +224,14 @@ void ChessBoard::print()
     std::string output;
     std::string finalOutput;
 
-    BitBoard occupied = boardinfo.whitePieces.board | boardinfo.blackPieces.board;
     for(int i = 0; i <= 63; i++)
     {
-        if(occupied.get(i))
-        {
-            if(BitBoard(boardinfo.pawns.board & boardinfo.whitePieces.board).get(i)) output+=" P ";
-            if(BitBoard(boardinfo.knights.board & boardinfo.whitePieces.board).get(i)) output+=" N ";
-            if(BitBoard(boardinfo.bishops.board & boardinfo.whitePieces.board).get(i)) output+=" B ";
-            if(BitBoard(boardinfo.rooks.board & boardinfo.whitePieces.board).get(i)) output+=" R ";
-            if(BitBoard(boardinfo.queens.board & boardinfo.whitePieces.board).get(i)) output+=" Q ";
-            if(BitBoard(boardinfo.kings.board & boardinfo.whitePieces.board).get(i)) output+=" K ";
-            if(BitBoard(boardinfo.pawns.board & boardinfo.blackPieces.board).get(i)) output+=" p ";
-            if(BitBoard(boardinfo.knights.board & boardinfo.blackPieces.board).get(i)) output+=" n ";
-            if(BitBoard(boardinfo.bishops.board & boardinfo.blackPieces.board).get(i)) output+=" b ";
-            if(BitBoard(boardinfo.rooks.board & boardinfo.blackPieces.board).get(i)) output+=" r ";
-            if(BitBoard(boardinfo.queens.board & boardinfo.blackPieces.board).get(i)) output+=" q ";
-            if(BitBoard(boardinfo.kings.board & boardinfo.blackPieces.board).get(i)) output+=" k ";
-        } 
+        std::string c = getPieceChar(i);
+        if(c != "0")
+            output+=" " + c + " ";
         else
-        {
             output+=" . ";
-        }
+
         if((i + 1) % 8 == 0){
             finalOutput.insert(0, output + "\n");
             output = "";
@@ -254,30 +247,29 @@ BitBoard ChessBoard::getBoard(Color color, PieceType piece)
 {
     assert(color == WHITE || color == BLACK);
 
-    U64 boardColor = boardinfo.whitePieces.board;
-    if(color == BLACK) boardColor = boardinfo.blackPieces.board;
+    BitBoard boardColor = getBoard(color);
 
     switch(piece){
         case PAWN:
-            return (boardColor & boardinfo.pawns.board);
+            return (boardColor & boardinfo.pawns);
             break;
         case KNIGHT:
-            return (boardColor & boardinfo.knights.board);
+            return (boardColor & boardinfo.knights);
             break;
         case BISHOP:
-            return (boardColor & boardinfo.bishops.board);
+            return (boardColor & boardinfo.bishops);
             break;
         case ROOK:
-            return (boardColor & boardinfo.rooks.board);
+            return (boardColor & boardinfo.rooks);
             break;
         case QUEEN:
-            return (boardColor & boardinfo.queens.board);
+            return (boardColor & boardinfo.queens);
             break;
         case KING:
-            return (boardColor & boardinfo.kings.board);
+            return (boardColor & boardinfo.kings);
             break;
         default:
-            return (boardinfo.whitePieces.board & boardinfo.pawns.board);
+            return (boardinfo.whitePieces & boardinfo.pawns);
             break;
     }
 }
@@ -286,13 +278,13 @@ BitBoard ChessBoard::getBoard(Color color)
 {
     assert(color == WHITE || color == BLACK);
 
-    if(color == WHITE) return (boardinfo.whitePieces.board);
-    return (boardinfo.blackPieces.board);
+    if(color == WHITE) return (boardinfo.whitePieces);
+    return (boardinfo.blackPieces);
 }
 
 BitBoard ChessBoard::getBlockers()
 {
-    return (boardinfo.whitePieces.board | boardinfo.blackPieces.board);
+    return (boardinfo.whitePieces | boardinfo.blackPieces);
 }
 
 bool ChessBoard::getWhiteToMove()
@@ -311,6 +303,17 @@ BitBoard * ChessBoard::getPieceOnSquare(int index)
     return 0;
 }
 
+PieceType ChessBoard::getPieceTypeOnSquare(int index)
+{
+    if(boardinfo.pawns.get(index)) return PAWN;
+    if(boardinfo.knights.get(index)) return KNIGHT;
+    if(boardinfo.bishops.get(index)) return BISHOP;
+    if(boardinfo.rooks.get(index)) return ROOK;
+    if(boardinfo.queens.get(index)) return QUEEN;
+    if(boardinfo.kings.get(index)) return KING;
+    return TYPE_UD;
+}
+
 BitBoard * ChessBoard::getColorOnSquare(int index)
 {
     if(boardinfo.whitePieces.get(index)) return(&boardinfo.whitePieces);
@@ -320,8 +323,7 @@ BitBoard * ChessBoard::getColorOnSquare(int index)
 
 bool ChessBoard::kingInCheck(Color color)
 {
-    BitBoard kingBoard = getBoard(color, KING);
-    int kingSquare = __builtin_ffsll(kingBoard.board) - 1;
+    int kingSquare = getBoard(color, KING).lsb();
 
     return squareAttacked(kingSquare, color);
 }
@@ -329,40 +331,51 @@ bool ChessBoard::kingInCheck(Color color)
 // idea is to generate a bitboard where all opponent attacks are a 1.
 bool ChessBoard::squareAttacked(int square, Color color)
 {
+    BitBoard theirPieces = getBoard(getOppositeColor(color));
+    U64 blockers = getBlockers().board;
+
     BitBoard pawnAttacks = Attacks::getNonSlidingAttacks(square, color, PAWN);
-    if(pawnAttacks.board & getBoard(getOppositeColor(color), PAWN).board) return true;
+    if(pawnAttacks & theirPieces & boardinfo.pawns) return true;
 
     BitBoard knightAttacks = Attacks::getNonSlidingAttacks(square, color, KNIGHT);
-    if(knightAttacks.board & getBoard(getOppositeColor(color), KNIGHT).board) return true;
+    if(knightAttacks & theirPieces & boardinfo.knights) return true;
 
     BitBoard kingAttacks = Attacks::getNonSlidingAttacks(square, color, KING);
-    if(kingAttacks.board & getBoard(getOppositeColor(color), KING).board) return true;
+    if(kingAttacks & theirPieces & boardinfo.kings) return true;
 
-    BitBoard bishopAttacks = Attacks::getSlidingAttacks(square, BISHOP, getBlockers().board);
-    if(bishopAttacks.board & getBoard(getOppositeColor(color), BISHOP).board) return true;
+    // queens attack like both bishops and rooks, so they are checked together with them.
+    BitBoard bishopAttacks = Attacks::getSlidingAttacks(square, BISHOP, blockers);
+    if(bishopAttacks & theirPieces & (boardinfo.bishops | boardinfo.queens)) return true;
 
-    BitBoard rookAttacks = Attacks::getSlidingAttacks(square, ROOK, getBlockers().board);
-    if(rookAttacks.board & getBoard(getOppositeColor(color), ROOK).board) return true;
-
-    BitBoard queenAttacks = Attacks::getSlidingAttacks(square, QUEEN, getBlockers().board);
-    if(queenAttacks.board & getBoard(getOppositeColor(color), QUEEN).board) return true;
+    BitBoard rookAttacks = Attacks::getSlidingAttacks(square, ROOK, blockers);
+    if(rookAttacks & theirPieces & (boardinfo.rooks | boardinfo.queens)) return true;
 
     return false;
 }
 
-void ChessBoard::setEnPassantPossibility(BitBoard ourPieces, int from, int to)
+BitBoard ChessBoard::attackersTo(int square, BitBoard occupied)
+{
+    // a white pawn attacks the square when a black pawn on the square would attack the white pawn, and the other way around.
+    BitBoard pawnAttackers = (BitBoard(Attacks::getNonSlidingAttacks(square, BLACK, PAWN)) & boardinfo.whitePieces)
+        | (BitBoard(Attacks::getNonSlidingAttacks(square, WHITE, PAWN)) & boardinfo.blackPieces);
+
+    return (pawnAttackers & boardinfo.pawns)
+        | (BitBoard(Attacks::getNonSlidingAttacks(square, WHITE, KNIGHT)) & boardinfo.knights)
+        | (BitBoard(Attacks::getNonSlidingAttacks(square, WHITE, KING)) & boardinfo.kings)
+        | (BitBoard(Attacks::getSlidingAttacks(square, BISHOP, occupied.board)) & (boardinfo.bishops | boardinfo.queens))
+        | (BitBoard(Attacks::getSlidingAttacks(square, ROOK, occupied.board)) & (boardinfo.rooks | boardinfo.queens));
+}
+
+void ChessBoard::setEnPassantPossibility(int from, int to)
 {
-    // There can only be one target at the time, so clearing the boards every move.
-    boardinfo.whiteEnPassantTarget.board = (U64)0;
-    boardinfo.blackEnPassantTarget.board = (U64)0;
     // black en passant possibility (white has double moved)
-    if((from / 8 == 1 && to / 8 == 3) && ourPieces.board & boardinfo.pawns.board)
+    if((from / 8 == 1 && to / 8 == 3) && boardinfo.pawns.get(to))
     {
         // set the square under the pawn as a target for a black pawn (in a seperate bitboard)
         boardinfo.blackEnPassantTarget.set(to - 8, true);
     }
     // white en passant possibility (black has double moved)
-    else if((from / 8 == 6 && to / 8 == 4) && ourPieces.board & boardinfo.pawns.board)
+    else if((from / 8 == 6 && to / 8 == 4) && boardinfo.pawns.get(to))
     {
         boardinfo.whiteEnPassantTarget.set(to + 8, true);
     }
@@ -371,192 +384,218 @@ void ChessBoard::setEnPassantPossibility(BitBoard ourPieces, int from, int to)
 void ChessBoard::updateCastlingRights()
 {
     // if the rooks have moved:
-    bool whiteQSRook = BitBoard(boardinfo.whitePieces.board & boardinfo.rooks.board).get(A1);
-    bool whiteKSRook = BitBoard(boardinfo.whitePieces.board & boardinfo.rooks.board).get(H1);
-    bool blackQSRook = BitBoard(boardinfo.blackPieces.board & boardinfo.rooks.board).get(A8);
-    bool blackKSRook = BitBoard(boardinfo.blackPieces.board & boardinfo.rooks.board).get(H8);
+    BitBoard whiteRooks = boardinfo.whitePieces & boardinfo.rooks;
+    BitBoard blackRooks = boardinfo.blackPieces & boardinfo.rooks;
     // castling rights can only go from true to false. If you move a rook back into proper position you cannot castle anymore.
-    if(!whiteQSRook && boardinfo.whiteCastleLong) boardinfo.whiteCastleLong = false;
-    if(!whiteKSRook && boardinfo.whiteCastleShort) boardinfo.whiteCastleShort = false;
-    if(!blackQSRook && boardinfo.blackCastleLong) boardinfo.blackCastleLong = false;
-    if(!blackKSRook && boardinfo.blackCastleShort) boardinfo.blackCastleShort = false;
+    if(!whiteRooks.get(A1)) boardinfo.whiteCastleLong = false;
+    if(!whiteRooks.get(H1)) boardinfo.whiteCastleShort = false;
+    if(!blackRooks.get(A8)) boardinfo.blackCastleLong = false;
+    if(!blackRooks.get(H8)) boardinfo.blackCastleShort = false;
 
     // if the kings have moved:
-    bool whiteKing = BitBoard(boardinfo.whitePieces.board & boardinfo.kings.board).get(E1);
-    bool blackKing = BitBoard(boardinfo.blackPieces.board & boardinfo.kings.board).get(E8);
-    if(!whiteKing && (boardinfo.whiteCastleLong || boardinfo.whiteCastleShort))
+    if(!(boardinfo.whitePieces & boardinfo.kings).get(E1))
     {
         boardinfo.whiteCastleLong = false;
         boardinfo.whiteCastleShort = false;
-    } else if (!blackKing && (boardinfo.blackCastleLong || boardinfo.blackCastleShort))
+    }
+    if(!(boardinfo.blackPieces & boardinfo.kings).get(E8))
     {
         boardinfo.blackCastleLong = false;
         boardinfo.blackCastleShort = false;
     }
 }
 
+BitBoard * ChessBoard::getPieceBoard(PieceType piece)
+{
+    switch(piece){
+        case PAWN: return &boardinfo.pawns;
+        case KNIGHT: return &boardinfo.knights;
+        case BISHOP: return &boardinfo.bishops;
+        case ROOK: return &boardinfo.rooks;
+        case QUEEN: return &boardinfo.queens;
+        case KING: return &boardinfo.kings;
+        default: return 0;
+    }
+}
+
+BitBoard * ChessBoard::getColorBoard(Color color)
+{
+    if(color == WHITE) return &boardinfo.whitePieces;
+    return &boardinfo.blackPieces;
+}
+
+void ChessBoard::putPiece(Color color, PieceType piece, int square)
+{
+    getPieceBoard(piece)->set(square, true);
+    getColorBoard(color)->set(square, true);
+    boardinfo.key ^= Zobrist::pieceKeys[color][piece][square];
+    if(piece == PAWN) boardinfo.pawnKey ^= Zobrist::pieceKeys[color][PAWN][square];
+    boardinfo.mgScore += Eval::mgTable[color][piece][square];
+    boardinfo.egScore += Eval::egTable[color][piece][square];
+    boardinfo.phase += Eval::phaseValues[piece];
+
+    if(network)
+        NNUE::addPiece(*network, boardinfo, accumulators.back(), color, piece, square);
+}
+
+void ChessBoard::removePiece(Color color, PieceType piece, int square)
+{
+    getPieceBoard(piece)->set(square, false);
+    getColorBoard(color)->set(square, false);
+    boardinfo.key ^= Zobrist::pieceKeys[color][piece][square];
+    if(piece == PAWN) boardinfo.pawnKey ^= Zobrist::pieceKeys[color][PAWN][square];
+    boardinfo.mgScore -= Eval::mgTable[color][piece][square];
+    boardinfo.egScore -= Eval::egTable[color][piece][square];
+    boardinfo.phase -= Eval::phaseValues[piece];
+
+    if(network)
+        NNUE::removePiece(*network, boardinfo, accumulators.back(), color, piece, square);
+}
+
+void ChessBoard::movePiece(Color color, PieceType piece, int from, int to)
+{
+    // a single xor clears the from square and sets the to square.
+    BitBoard fromTo = BitBoard((U64)1 << from) | BitBoard((U64)1 << to);
+    *getPieceBoard(piece) ^= fromTo;
+    *getColorBoard(color) ^= fromTo;
+    boardinfo.key ^= Zobrist::pieceKeys[color][piece][from] ^ Zobrist::pieceKeys[color][piece][to];
+    if(piece == PAWN) boardinfo.pawnKey ^= Zobrist::pieceKeys[color][PAWN][from] ^ Zobrist::pieceKeys[color][PAWN][to];
+    boardinfo.mgScore += Eval::mgTable[color][piece][to] - Eval::mgTable[color][piece][from];
+    boardinfo.egScore += Eval::egTable[color][piece][to] - Eval::egTable[color][piece][from];
+
+    // king moves change every feature of their own side, pushMove refreshes that side afterwards.
+    if(network)
+        NNUE::movePiece(*network, boardinfo, accumulators.back(), color, piece, from, to);
+}
+
 void ChessBoard::pushCastlingMove(Move move)
 {
-    int from = from_Square(move);
     int to = to_Square(move);
-    // gets the bitboard corresponding to our piece color.
-    BitBoard * ourPieces = getColorOnSquare(from);
-
-    // I already thought of a more efficient way of writing this but cannot be asked at the moment. + this is probably quite fast.
+    Color us = boardinfo.whiteToMove ? WHITE : BLACK;
 
     // white ks castle
-    if(to == 6 && boardinfo.whiteCastleShort)
+    if(to == G1 && boardinfo.whiteCastleShort)
     {
-        boardinfo.kings.set(E1, false);
-        boardinfo.rooks.set(H1, false);
-        boardinfo.kings.set(G1, true);
-        boardinfo.rooks.set(F1, true);
-        ourPieces->set(E1, false);
-        ourPieces->set(H1, false);
-        ourPieces->set(G1, true);
-        ourPieces->set(F1, true);
+        movePiece(us, KING, E1, G1);
+        movePiece(us, ROOK, H1, F1);
     } 
     // white qs castle
-    else if (to == 2 && boardinfo.whiteCastleLong)
+    else if (to == C1 && boardinfo.whiteCastleLong)
     {
-        boardinfo.kings.set(E1, false);
-        boardinfo.rooks.set(A1, false);
-        boardinfo.kings.set(C1, true);
-        boardinfo.rooks.set(D1, true);
-        ourPieces->set(E1, false);
-        ourPieces->set(A1, false);
-        ourPieces->set(C1, true);
-        ourPieces->set(D1, true);
+        movePiece(us, KING, E1, C1);
+        movePiece(us, ROOK, A1, D1);
     }
-    // black qs castle
-    else if (to == 58 && boardinfo.blackCastleLong)
+    // black ks castle
+    else if (to == G8 && boardinfo.blackCastleShort)
     {
-        boardinfo.kings.set(E8, false);
-        boardinfo.rooks.set(H8, false);
-        boardinfo.kings.set(G8, true);
-        boardinfo.rooks.set(F8, true);
-        ourPieces->set(E8, false);
-        ourPieces->set(H8, false);
-        ourPieces->set(G8, true);
-        ourPieces->set(F8, true);
+        movePiece(us, KING, E8, G8);
+        movePiece(us, ROOK, H8, F8);
     } 
-    // black ks castle
-    else if (to == 62 && boardinfo.blackCastleShort)
+    // black qs castle
+    else if (to == C8 && boardinfo.blackCastleLong)
     {
-        boardinfo.kings.set(E8, false);
-        boardinfo.rooks.set(A8, false);
-        boardinfo.kings.set(C8, true);
-        boardinfo.rooks.set(D8, true);
-        ourPieces->set(E8, false);
-        ourPieces->set(A8, false);
-        ourPieces->set(C8, true);
-        ourPieces->set(D8, true);
+        movePiece(us, KING, E8, C8);
+        movePiece(us, ROOK, A8, D8);
     } else {
         std::cout<<"No castling rights!"<<std::endl;
     }
+
+    boardinfo.fiftyMoveRule++;
 }
 
 void ChessBoard::pushPromotionMove(Move move)
 {
     int from = from_Square(move);
     int to = to_Square(move);
+    Color us = boardinfo.whiteToMove ? WHITE : BLACK;
 
-    BitBoard * ourPieces = getColorOnSquare(from);
-
-    PieceType piece = movePromotionType(move);
+    // capturing promotions have to remove the captured piece first.
+    PieceType captured = getPieceTypeOnSquare(to);
+    if(captured != TYPE_UD)
+        removePiece(getOppositeColor(us), captured, to);
 
-    boardinfo.pawns.set(from, false);
-    ourPieces->set(from, false);
-    ourPieces->set(to, true);
+    removePiece(us, PAWN, from);
+    putPiece(us, movePromotionType(move), to);
 
-    if(piece == QUEEN) boardinfo.queens.set(to, true);
-    if(piece == ROOK) boardinfo.rooks.set(to, true);
-    if(piece == BISHOP) boardinfo.bishops.set(to, true);
-    if(piece == KNIGHT) boardinfo.knights.set(to, true);
+    boardinfo.fiftyMoveRule = 0;
 }
 
 void ChessBoard::pushEnPassantMove(Move move)
 {
     int from = from_Square(move);
     int to = to_Square(move);
+    Color us = boardinfo.whiteToMove ? WHITE : BLACK;
 
-    BitBoard * ourPieceType = getPieceOnSquare(from);
+    // the captured pawn is not on the target square but under it (white) or above it (black).
+    int capturedSquare = us == WHITE ? to - 8 : to + 8;
 
-    // White double pawn move (this needs to be seperated because we need to remove the pawn above or under the targetted square)
-    if(from >= A5)
-    {
-        BitBoard * theirPiece = getPieceOnSquare(to - 8);
-        boardinfo.whitePieces.set(from, false);
-        boardinfo.whitePieces.set(to, true);
-        ourPieceType->set(from, false);
-        ourPieceType->set(to, true);
-        theirPiece->set(to - 8, false);
-        boardinfo.blackPieces.set(to - 8, false);
-    } 
-    else if(from <= H4)
-    {
-        BitBoard * theirPiece = getPieceOnSquare(to + 8);
-        boardinfo.blackPieces.set(from, false);
-        boardinfo.blackPieces.set(to, true);
-        ourPieceType->set(from, false);
-        ourPieceType->set(to, true);
-        theirPiece->set(to + 8, false);
-        boardinfo.whitePieces.set(to + 8, false);
-    }
+    movePiece(us, PAWN, from, to);
+    removePiece(getOppositeColor(us), PAWN, capturedSquare);
+
+    boardinfo.fiftyMoveRule = 0;
 }
 
 void ChessBoard::pushRegularMove(Move move)
 {
     int from = from_Square(move);
     int to = to_Square(move);
+    Color us = boardinfo.whiteToMove ? WHITE : BLACK;
 
-    // gets the bitboard corresponding to our piecetype, e.g. knights, pawns etc.
-    BitBoard * ourPieceType = getPieceOnSquare(from);
-    // gets the bitboard corresponding to the opponent piecetype (at least if it is a capture).
-    BitBoard * theirPieceType = getPieceOnSquare(to);
-    // if board is empty it returns 0.
-    bool isCapture = theirPieceType;
-    // gets the bitboard corresponding to our piece color.
-    BitBoard * ourPieces = getColorOnSquare(from);
+    // gets our piecetype, e.g. knights, pawns etc.
+    PieceType ourType = getPieceTypeOnSquare(from);
+    // gets the opponent piecetype (at least if it is a capture), TYPE_UD when the square is empty.
+    PieceType theirType = getPieceTypeOnSquare(to);
 
     boardinfo.fiftyMoveRule++;
 
-    if (boardinfo.pawns.board & ourPieceType->board)    
+    if (ourType == PAWN)
         boardinfo.fiftyMoveRule = 0;
 
-    if(isCapture)
+    if(theirType != TYPE_UD)
     {
-        theirPieceType->set(to, false);
-
-        BitBoard * theirPieces = getColorOnSquare(to);
-        theirPieces->set(to, false);
+        removePiece(getOppositeColor(us), theirType, to);
         boardinfo.fiftyMoveRule = 0;
     }
-    // changing to the position of a piece on one of the piece boards: pawn, knight, rook king etc.
-    ourPieceType->set(from, false);
-    ourPieceType->set(to, true);
-    // changing the position of the piece on the white_pieces or black_pieces board.
-    ourPieces->set(from, false);
-    ourPieces->set(to, true);
 
-    setEnPassantPossibility(*ourPieces, from, to);
+    movePiece(us, ourType, from, to);
+
+    setEnPassantPossibility(from, to);
 }
 
 void ChessBoard::pushMove(Move move)
 {
-    // setting previous board information the the current position when there has not been made a move.
-    previousBoard = boardinfo;
+    // saving the current board information so the move can be undone.
+    history.push_back(boardinfo);
+    // the accumulator of the new position starts as a copy of the current one and is updated by the piece functions.
+    if(network)
+        accumulators.push_back(accumulators.back());
     // getting the movetype
     MoveType type = moveType(move);
 
+    // castling rights and en passant are hashed out here and hashed back in once the move has been made.
+    boardinfo.key ^= stateKey(boardinfo);
+    // an en passant target only lives for one move, a double pawn push sets a new one.
+    boardinfo.whiteEnPassantTarget = BitBoard();
+    boardinfo.blackEnPassantTarget = BitBoard();
+
     if(type == CASTLING) pushCastlingMove(move);
     else if(type == PROMOTION) pushPromotionMove(move);
     else if(type == ENPASSANT) pushEnPassantMove(move);
     else if(type == NORMAL) pushRegularMove(move);
 
+    // a king move (or castling) changes the king square all features of its side are relative to.
+    Color us = boardinfo.whiteToMove ? WHITE : BLACK;
+    if(network && (boardinfo.kings & *getColorBoard(us)) != (history.back().kings & *getColorBoard(us)))
+        NNUE::refresh(*network, boardinfo, accumulators.back(), us);
+
     // Update board information
     updateCastlingRights();
     boardinfo.whiteToMove = !boardinfo.whiteToMove;
+    boardinfo.key ^= stateKey(boardinfo) ^ Zobrist::sideKey;
+
+    // the key is final now, loading its bucket overlaps with the rest of the work done before the probe.
+    if(prefetchTable)
+        prefetchTable->prefetch(boardinfo.key);
 
     if (boardinfo.whiteToMove)
         boardinfo.plyCount++;
@@ -565,7 +604,110 @@ void ChessBoard::pushMove(Move move)
 // removes one move from the list.
 void ChessBoard::popMove()
 {
-    boardinfo = previousBoard;
+    assert(!history.empty());
+    boardinfo = history.back();
+    history.pop_back();
+
+    if(network)
+        accumulators.pop_back();
+}
+
+void ChessBoard::pushNullMove()
+{
+    history.push_back(boardinfo);
+    if(network)
+        accumulators.push_back(accumulators.back());
+
+    // passing the turn removes any en passant possibility, the piece boards are left untouched.
+    boardinfo.key ^= stateKey(boardinfo);
+    boardinfo.whiteEnPassantTarget = BitBoard();
+    boardinfo.blackEnPassantTarget = BitBoard();
+    boardinfo.whiteToMove = !boardinfo.whiteToMove;
+    boardinfo.key ^= stateKey(boardinfo) ^ Zobrist::sideKey;
+
+    if(prefetchTable)
+        prefetchTable->prefetch(boardinfo.key);
+
+    boardinfo.fiftyMoveRule++;
+    if (boardinfo.whiteToMove)
+        boardinfo.plyCount++;
+}
+
+void ChessBoard::popNullMove()
+{
+    assert(!history.empty());
+    boardinfo = history.back();
+    history.pop_back();
+
+    if(network)
+        accumulators.pop_back();
+}
+
+void ChessBoard::setNetwork(const NNUE::Network * network)
+{
+    this->network = network;
+    refreshAccumulators();
+}
+
+void ChessBoard::refreshAccumulators()
+{
+    accumulators.clear();
+    if(!network) return;
+
+    accumulators.resize(history.size() + 1);
+    for(size_t i = 0; i < history.size(); i++)
+        NNUE::refresh(*network, history[i], accumulators[i]);
+    NNUE::refresh(*network, boardinfo, accumulators.back());
+}
+
+U64 ChessBoard::getKey()
+{
+    return boardinfo.key;
+}
+
+U64 ChessBoard::stateKey(BoardInfo info)
+{
+    U64 key = (U64)0;
+
+    if(info.whiteCastleShort) key ^= Zobrist::castlingKeys[0];
+    if(info.whiteCastleLong) key ^= Zobrist::castlingKeys[1];
+    if(info.blackCastleShort) key ^= Zobrist::castlingKeys[2];
+    if(info.blackCastleLong) key ^= Zobrist::castlingKeys[3];
+
+    // there is at most one en passant target at the time.
+    BitBoard enPassant = info.whiteEnPassantTarget | info.blackEnPassantTarget;
+    if(enPassant)
+        key ^= Zobrist::enPassantKeys[enPassant.lsb() % 8];
+
+    return key;
+}
+
+U64 ChessBoard::computeKey(BoardInfo info)
+{
+    U64 key = stateKey(info);
+
+    BitBoard pieceBoards[6] = {info.pawns, info.knights, info.bishops, info.rooks, info.queens, info.kings};
+
+    for(int p = PAWN; p <= KING; p++)
+    {
+        for(int sq : pieceBoards[p] & info.whitePieces) key ^= Zobrist::pieceKeys[WHITE][p][sq];
+        for(int sq : pieceBoards[p] & info.blackPieces) key ^= Zobrist::pieceKeys[BLACK][p][sq];
+    }
+
+    if(!info.whiteToMove)
+        key ^= Zobrist::sideKey;
+
+    return key;
+}
+
+U64 ChessBoard::computePawnKey(BoardInfo info)
+{
+    U64 key = 0;
+
+    for(int sq : info.pawns & info.whitePieces) key ^= Zobrist::pieceKeys[WHITE][PAWN][sq];
+    for(int sq : info.pawns & info.blackPieces) key ^= Zobrist::pieceKeys[BLACK][PAWN][sq];
+
+    return key;
 }
 
 Color ChessBoard::getOppositeColor(Color color)
@@ -576,19 +718,14 @@ Color ChessBoard::getOppositeColor(Color color)
 
 std::string ChessBoard::getPieceChar(int i)
 {
-    if(BitBoard(boardinfo.pawns.board & boardinfo.whitePieces.board).get(i)) return "P";
-    if(BitBoard(boardinfo.knights.board & boardinfo.whitePieces.board).get(i)) return "N";
-    if(BitBoard(boardinfo.bishops.board & boardinfo.whitePieces.board).get(i)) return "B";
-    if(BitBoard(boardinfo.rooks.board & boardinfo.whitePieces.board).get(i)) return "R";
-    if(BitBoard(boardinfo.queens.board & boardinfo.whitePieces.board).get(i)) return "Q";
-    if(BitBoard(boardinfo.kings.board & boardinfo.whitePieces.board).get(i)) return "K";
-    if(BitBoard(boardinfo.pawns.board & boardinfo.blackPieces.board).get(i)) return "p";
-    if(BitBoard(boardinfo.knights.board & boardinfo.blackPieces.board).get(i)) return "n";
-    if(BitBoard(boardinfo.bishops.board & boardinfo.blackPieces.board).get(i)) return "b";
-    if(BitBoard(boardinfo.rooks.board & boardinfo.blackPieces.board).get(i)) return "r";
-    if(BitBoard(boardinfo.queens.board & boardinfo.blackPieces.board).get(i)) return "q";
-    if(BitBoard(boardinfo.kings.board & boardinfo.blackPieces.board).get(i)) return "k";
-    return "0";
+    const char* whiteChars = "PNBRQK";
+    const char* blackChars = "pnbrqk";
+
+    PieceType piece = getPieceTypeOnSquare(i);
+    if(piece == TYPE_UD) return "0";
+
+    if(boardinfo.whitePieces.get(i)) return std::string(1, whiteChars[piece]);
+    return std::string(1, blackChars[piece]);
 }
 
 std::string ChessBoard::convertToFen()
@@ -680,10 +817,10 @@ Move ChessBoard::fromUci(std::string move)
         }
     }
     // castling moves: check if the move is on the castling squares and if the king is moved.
-    if(from == E1 && to == G1 && (getPieceOnSquare(from)->board & boardinfo.kings.board)) return createMove(from, to, CASTLING);
-    else if(from == E1 && to == C1 && (getPieceOnSquare(from)->board & boardinfo.kings.board)) return createMove(from, to, CASTLING);
-    else if(from == E8 && to == G8 && (getPieceOnSquare(from)->board & boardinfo.kings.board)) return createMove(from, to, CASTLING);
-    else if(from == E8 && to == C8 && (getPieceOnSquare(from)->board & boardinfo.kings.board)) return createMove(from, to, CASTLING);
+    if(from == E1 && to == G1 && boardinfo.kings.get(from)) return createMove(from, to, CASTLING);
+    else if(from == E1 && to == C1 && boardinfo.kings.get(from)) return createMove(from, to, CASTLING);
+    else if(from == E8 && to == G8 && boardinfo.kings.get(from)) return createMove(from, to, CASTLING);
+    else if(from == E8 && to == C8 && boardinfo.kings.get(from)) return createMove(from, to, CASTLING);
 
     // en passant moves
     if(boardinfo.blackEnPassantTarget.get(to) && getBoard(BLACK, PAWN).get(from)) return createMove(from, to, ENPASSANT);
@@ -706,4 +843,123 @@ bool ChessBoard::isCheckMate()
 
     if(legalMoves.size() == 0) return true;
     else return false;
+}
+
+bool ChessBoard::isRepetition()
+{
+    // history.back() has the other side to move, so only every second entry can be the same position.
+    // positions from before the last capture or pawn move can never occur again.
+    int last = (int)history.size() - 2;
+    int oldest = (int)history.size() - boardinfo.fiftyMoveRule;
+
+    for(int i = last; i >= 0 && i >= oldest; i -= 2)
+    {
+        if(history[i].key == boardinfo.key) return true;
+    }
+    return false;
+}
+
+bool ChessBoard::isDraw()
+{
+    return boardinfo.fiftyMoveRule >= 100 || isRepetition();
+}
+
+BoardInfo ChessBoard::flipInfo(BoardInfo info)
+{
+    BoardInfo output = info;
+
+    // the colors are swapped, so white pieces end up on the black board and the other way around.
+    output.whitePieces = info.blackPieces.flipVertical();
+    output.blackPieces = info.whitePieces.flipVertical();
+    output.pawns = info.pawns.flipVertical();
+    output.knights = info.knights.flipVertical();
+    output.bishops = info.bishops.flipVertical();
+    output.rooks = info.rooks.flipVertical();
+    output.queens = info.queens.flipVertical();
+    output.kings = info.kings.flipVertical();
+
+    output.whiteToMove = !info.whiteToMove;
+
+    output.whiteCastleShort = info.blackCastleShort;
+    output.whiteCastleLong = info.blackCastleLong;
+    output.blackCastleShort = info.whiteCastleShort;
+    output.blackCastleLong = info.whiteCastleLong;
+
+    // a target for black (on the third rank) becomes a target for white (on the sixth rank).
+    output.whiteEnPassantTarget = info.blackEnPassantTarget.flipVertical();
+    output.blackEnPassantTarget = info.whiteEnPassantTarget.flipVertical();
+
+    return output;
+}
+
+BoardInfo ChessBoard::mirrorInfo(BoardInfo info)
+{
+    BoardInfo output = info;
+
+    output.whitePieces = info.whitePieces.mirrorHorizontal();
+    output.blackPieces = info.blackPieces.mirrorHorizontal();
+    output.pawns = info.pawns.mirrorHorizontal();
+    output.knights = info.knights.mirrorHorizontal();
+    output.bishops = info.bishops.mirrorHorizontal();
+    output.rooks = info.rooks.mirrorHorizontal();
+    output.queens = info.queens.mirrorHorizontal();
+    output.kings = info.kings.mirrorHorizontal();
+
+    output.whiteEnPassantTarget = info.whiteEnPassantTarget.mirrorHorizontal();
+    output.blackEnPassantTarget = info.blackEnPassantTarget.mirrorHorizontal();
+
+    return output;
+}
+
+ChessBoard ChessBoard::flipped()
+{
+    ChessBoard board = *this;
+
+    board.boardinfo = flipInfo(boardinfo);
+    board.boardinfo.key = computeKey(board.boardinfo);
+    board.boardinfo.pawnKey = computePawnKey(board.boardinfo);
+    Eval::refreshScores(board.boardinfo);
+
+    for(BoardInfo &info : board.history)
+    {
+        info = flipInfo(info);
+        info.key = computeKey(info);
+        info.pawnKey = computePawnKey(info);
+        Eval::refreshScores(info);
+    }
+    board.refreshAccumulators();
+
+    return board;
+}
+
+ChessBoard ChessBoard::mirrored()
+{
+    ChessBoard board = *this;
+
+    board.boardinfo = mirrorInfo(boardinfo);
+    board.boardinfo.key = computeKey(board.boardinfo);
+    board.boardinfo.pawnKey = computePawnKey(board.boardinfo);
+    Eval::refreshScores(board.boardinfo);
+
+    for(BoardInfo &info : board.history)
+    {
+        info = mirrorInfo(info);
+        info.key = computeKey(info);
+        info.pawnKey = computePawnKey(info);
+        Eval::refreshScores(info);
+    }
+    board.refreshAccumulators();
+
+    return board;
+}
+
+int ChessBoard::getFeatures(Features::FeatureSet set, Color perspective, uint32_t * features)
+{
+    return Features::activeFeatures(boardinfo, set, perspective, features);
+}
+
+void ChessBoard::getFeatureDiff(Features::FeatureSet set, Color perspective, Features::FeatureDiff& diff)
+{
+    assert(!history.empty());
+    Features::diff(history.back(), boardinfo, set, perspective, diff);
 }
\ No newline at end of file
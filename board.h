@@ -3,10 +3,17 @@
 
 #include <bitboard.h>
 #include <move.h>
+#include <nnue.h>
+#include <featureset.h>
 #include <iostream>
+#include <vector>
 
 namespace nnchesslib
 {
+    class TranspositionTable;
+    class PawnTable;
+    class EvalCache;
+
     struct BoardInfo
     {
         BitBoard whitePieces;
@@ -30,6 +37,16 @@ namespace nnchesslib
 
         BitBoard whiteEnPassantTarget;
         BitBoard blackEnPassantTarget;
+
+        // Zobrist hash of the position, updated incrementally when pushing moves.
+        U64 key = 0;
+        // Zobrist hash of only the pawns, for the pawn table.
+        U64 pawnKey = 0;
+
+        // Material plus piece-square scores from white's view and the game phase, updated together with the key.
+        int16_t mgScore = 0;
+        int16_t egScore = 0;
+        int phase = 0;
     };
 
     class ChessBoard
@@ -37,13 +54,34 @@ namespace nnchesslib
         private:
             // Generate bitboards corresponding to a given fen.
             void generateBitBoards(std::string fen);
+            // Flips board information vertically and swaps the colors.
+            static BoardInfo flipInfo(BoardInfo info);
+            // Mirrors board information horizontally.
+            static BoardInfo mirrorInfo(BoardInfo info);
+            // Zobrist key of the castling rights and en passant target, these change on almost every move.
+            static U64 stateKey(BoardInfo info);
+            // Recomputes the accumulators of all positions in the history and the current one.
+            void refreshAccumulators();
         public:
             BoardInfo boardinfo;
-            BoardInfo previousBoard;
+            // Undo stack, pushMove saves the board information here and popMove restores it.
+            std::vector<BoardInfo> history;
+            // When set, pushMove prefetches the bucket of the new position so it is cached once the search probes it.
+            TranspositionTable * prefetchTable = nullptr;
+            // When set, the evaluation caches the pawn structure here.
+            PawnTable * pawnTable = nullptr;
+            // When set, static evaluations are looked up here first and stored here after evaluating.
+            EvalCache * evalCache = nullptr;
+            // When set, the pieces are kept in NNUE accumulators, one for every history entry followed by the current position.
+            const NNUE::Network * network = nullptr;
+            std::vector<NNUE::Accumulator> accumulators;
 
             ChessBoard();
             ChessBoard(std::string fenRepresentation);
 
+            // Sets the network the accumulators are kept for, nullptr stops updating them.
+            void setNetwork(const NNUE::Network * network);
+
             // Determine whether a fen is valid.
             bool isValidFen(std::string fen);
             // Cout current instance of board. 
@@ -62,13 +100,27 @@ namespace nnchesslib
             BitBoard * getPieceOnSquare(int index);
             // Returns the color bitboard by looking at which piece is on a specific index.
             BitBoard * getColorOnSquare(int index);
+            // Returns the bitboard that stores a piece type, e.g. boardinfo.knights for KNIGHT.
+            BitBoard * getPieceBoard(PieceType piece);
+            // Returns the bitboard that stores the pieces of a color.
+            BitBoard * getColorBoard(Color color);
+
+            // Puts a piece on an empty square, keeping the zobrist key up to date.
+            void putPiece(Color color, PieceType piece, int square);
+            // Removes a piece from a square, keeping the zobrist key up to date.
+            void removePiece(Color color, PieceType piece, int square);
+            // Moves a piece to an empty square, keeping the zobrist key up to date.
+            void movePiece(Color color, PieceType piece, int from, int to);
 
             // Determines whether a black or white king is in check. Usage: kingInCheck(BLACK) returns true if black king in check.
             bool kingInCheck(Color color);
             // Determines whether a square is attacked by an opponent piece.
             bool squareAttacked(int square, Color color);
+            // Returns the pieces of both colors that attack a square, sliding attacks are blocked by the given occupancy.
+            BitBoard attackersTo(int square, BitBoard occupied);
 
-            void setEnPassantPossibility(BitBoard ourPieces, int from, int to);
+            // Sets the en passant target behind a double pawn push, pushMove has already cleared the old one.
+            void setEnPassantPossibility(int from, int to);
             // Updates the boards castling rights.
             void updateCastlingRights();
 
@@ -84,6 +136,19 @@ namespace nnchesslib
             void pushMove(Move move);
             // Undo's a move.
             void popMove();
+            // Passes the turn to the opponent without moving a piece (used for null-move pruning).
+            void pushNullMove();
+            // Undo's a null move.
+            void popNullMove();
+
+            // Returns the zobrist key of the current position.
+            U64 getKey();
+            // Calculates the zobrist key of a position from scratch.
+            static U64 computeKey(BoardInfo info);
+            // Calculates the pawn key of a position from scratch.
+            static U64 computePawnKey(BoardInfo info);
+            // Returns the piece type on a square or TYPE_UD if it is empty.
+            PieceType getPieceTypeOnSquare(int index);
 
             // Returns the opposite color: BLACK -> WHITE
             Color getOppositeColor(Color color);
@@ -100,6 +165,21 @@ namespace nnchesslib
             void pushFromUci(std::string uci);
             // Returns true if checkmate.
             bool isCheckMate();
+            // Returns true if the current position occurred before since the last capture or pawn move.
+            bool isRepetition();
+            // Returns true if the position is drawn by repetition or the fifty move rule.
+            bool isDraw();
+
+            // Returns the position flipped vertically with the colors swapped, so black's position becomes white's.
+            ChessBoard flipped();
+            // Returns the position mirrored horizontally. Only meaningful for pawnless positions without castling rights.
+            ChessBoard mirrored();
+
+            // Writes the active input features of a feature set from one side's perspective and returns how many,
+            // features must have room for Features::MAX_ACTIVE_FEATURES entries.
+            int getFeatures(Features::FeatureSet set, Color perspective, uint32_t * features);
+            // Writes the features the last move added and removed from one side's perspective.
+            void getFeatureDiff(Features::FeatureSet set, Color perspective, Features::FeatureDiff& diff);
     };
 }
 
@@ -0,0 +1,57 @@
+// Evalcache.cpp | Lock-free cache of static evaluations shared between threads.
+
+#include <evalcache.h>
+#include <algorithm>
+#include <cstdint>
+
+using namespace nnchesslib;
+
+EvalCache nnchesslib::evalCache;
+
+static const U64 EVAL_MASK = 0xFFFF;
+
+void EvalCache::resize(size_t megabytes)
+{
+    entryCount = (U64)megabytes * 1024 * 1024 / sizeof(std::atomic<U64>);
+    // keep only the highest bit, so the index is a mask of the key.
+    if(entryCount)
+        entryCount = 1ULL << (63 - __builtin_clzll(entryCount));
+    entries.reset(entryCount ? new std::atomic<U64>[entryCount] : nullptr);
+    clear();
+}
+
+void EvalCache::clear()
+{
+    for(U64 i = 0; i < entryCount; i++)
+        entries[i].store(0, std::memory_order_relaxed);
+}
+
+bool EvalCache::empty()
+{
+    return entryCount == 0;
+}
+
+std::atomic<U64> * EvalCache::getEntry(U64 key)
+{
+    // the low bits select the entry, the high bits stored in it verify the rest of the key.
+    return &entries[key & (entryCount - 1)];
+}
+
+bool EvalCache::probe(U64 key, int &eval)
+{
+    if(!entryCount) return false;
+
+    U64 data = getEntry(key)->load(std::memory_order_relaxed);
+    if((data ^ key) & ~EVAL_MASK) return false;
+
+    eval = (int16_t)(data & EVAL_MASK);
+    return true;
+}
+
+void EvalCache::store(U64 key, int eval)
+{
+    if(!entryCount) return;
+
+    eval = std::clamp(eval, (int)INT16_MIN, (int)INT16_MAX);
+    getEntry(key)->store((key & ~EVAL_MASK) | (uint16_t)eval, std::memory_order_relaxed);
+}
@@ -0,0 +1,39 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include <types.h>
+#include <atomic>
+#include <memory>
+
+namespace nnchesslib
+{
+    // Static evaluations by position key. Every entry is a single 64 bit word holding the upper 48 bits of the
+    // key and a 16 bit evaluation, so it is written in one store and can be shared by threads without locks.
+    // The entry count is a power of two indexed by the low bits of the key, so with 2^n entries the stored
+    // bits check 64 - max(n, 16) key bits that the index did not already select on, 45 bits for 4 MB.
+    class EvalCache
+    {
+        private:
+            std::unique_ptr<std::atomic<U64>[]> entries;
+            U64 entryCount = 0;
+
+            std::atomic<U64> * getEntry(U64 key);
+
+        public:
+            // Allocates a cache of at most the given size in megabytes, rounded down to a power of two entries,
+            // clearing all entries. 0 disables the cache.
+            void resize(size_t megabytes);
+            void clear();
+            bool empty();
+
+            // Looks up a position, returns true and sets eval when it is found.
+            bool probe(U64 key, int &eval);
+            // Stores the evaluation of a position, replacing whatever was in its entry.
+            void store(U64 key, int eval);
+    };
+
+    // Evaluation cache shared by all search threads, it keeps its entries between searches.
+    extern EvalCache evalCache;
+}
+
+#endif
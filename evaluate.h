@@ -0,0 +1,36 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include <board.h>
+#include <cstdint>
+
+namespace nnchesslib
+{
+    namespace Eval
+    {
+        // Piece values in centipawns, indexed by PieceType.
+        const int pieceValues[6] = {100, 320, 330, 500, 900, 0};
+
+        // Game phase each piece adds, all pieces on the board make MAX_PHASE (the middlegame), none the endgame.
+        const int phaseValues[6] = {0, 1, 1, 2, 4, 0};
+        const int MAX_PHASE = 24;
+
+        // Material plus piece-square scores of a piece on a square from white's view, for the middlegame and endgame.
+        // Indexed by [color][piece][square], black's entries are flipped vertically and negated.
+        extern int16_t mgTable[2][6][64];
+        extern int16_t egTable[2][6][64];
+
+        // Fills mgTable and egTable.
+        void initTables();
+
+        // Computes the incremental terms of a position (mgScore, egScore and phase) from scratch.
+        void refreshScores(BoardInfo& info);
+
+        // Returns the static evaluation of a position in centipawns, seen from the side to move. Uses the network
+        // when the board has one, otherwise the incremental scores, pawn structure, mobility and rooks on open files
+        // tapered by the phase. Boards with an evaluation cache look the position up there first.
+        int evaluate(ChessBoard& board);
+    }
+}
+
+#endif
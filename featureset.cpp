@@ -0,0 +1,197 @@
+// Featureset.cpp | Sparse input features of positions for training and evaluating networks.
+
+#include <featureset.h>
+#include <board.h>
+#include <nnue.h>
+#include <evaluate.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace nnchesslib;
+
+int Features::featureCount(FeatureSet set)
+{
+    if(set == PIECE_SQUARE) return 12 * 64;
+    if(set == HALF_KP) return NNUE::FEATURES;
+    return 64 * 12 * 64;
+}
+
+static int kingSquareOf(const BoardInfo& info, Color color)
+{
+    return (info.kings & (color == WHITE ? info.whitePieces : info.blackPieces)).lsb();
+}
+
+// Index of a piece from one side's perspective, kingSquare is that side's king and only used by the king sets.
+static uint32_t featureIndex(Features::FeatureSet set, Color perspective, int kingSquare, Color color, PieceType piece, int square)
+{
+    if(set == Features::HALF_KP)
+        return NNUE::featureIndex(perspective, kingSquare, color, piece, square);
+
+    int flip = perspective == BLACK ? 56 : 0;
+    int pieceIndex = piece * 2 + (color != perspective);
+    if(set == Features::PIECE_SQUARE)
+        return pieceIndex * 64 + (square ^ flip);
+    return ((kingSquare ^ flip) * 12 + pieceIndex) * 64 + (square ^ flip);
+}
+
+int Features::activeFeatures(const BoardInfo& info, FeatureSet set, Color perspective, uint32_t * features)
+{
+    const BitBoard pieceBoards[6] = {info.pawns, info.knights, info.bishops, info.rooks, info.queens, info.kings};
+    int kingSquare = kingSquareOf(info, perspective);
+    // halfkp has no king features, the king square is part of every other feature.
+    int lastPiece = set == HALF_KP ? QUEEN : KING;
+    int count = 0;
+
+    for(int piece = PAWN; piece <= lastPiece; piece++)
+    {
+        for(int square : pieceBoards[piece] & info.whitePieces)
+            features[count++] = featureIndex(set, perspective, kingSquare, WHITE, PieceType(piece), square);
+        for(int square : pieceBoards[piece] & info.blackPieces)
+            features[count++] = featureIndex(set, perspective, kingSquare, BLACK, PieceType(piece), square);
+    }
+    return count;
+}
+
+void Features::diff(const BoardInfo& parent, const BoardInfo& child, FeatureSet set, Color perspective, FeatureDiff& result)
+{
+    result.addedCount = 0;
+    result.removedCount = 0;
+    result.refresh = false;
+
+    int kingSquare = kingSquareOf(child, perspective);
+    if(set != PIECE_SQUARE && kingSquare != kingSquareOf(parent, perspective))
+    {
+        result.refresh = true;
+        return;
+    }
+
+    const BitBoard parentBoards[6] = {parent.pawns, parent.knights, parent.bishops, parent.rooks, parent.queens, parent.kings};
+    const BitBoard childBoards[6] = {child.pawns, child.knights, child.bishops, child.rooks, child.queens, child.kings};
+    int lastPiece = set == HALF_KP ? QUEEN : KING;
+
+    for(Color color : {WHITE, BLACK})
+    {
+        BitBoard parentColor = color == WHITE ? parent.whitePieces : parent.blackPieces;
+        BitBoard childColor = color == WHITE ? child.whitePieces : child.blackPieces;
+
+        for(int piece = PAWN; piece <= lastPiece; piece++)
+        {
+            BitBoard before = parentBoards[piece] & parentColor;
+            BitBoard after = childBoards[piece] & childColor;
+            if(before == after) continue;
+
+            for(int square : before & ~after)
+            {
+                if(result.removedCount == MAX_CHANGED_FEATURES) { result.refresh = true; return; }
+                result.removed[result.removedCount++] = featureIndex(set, perspective, kingSquare, color, PieceType(piece), square);
+            }
+            for(int square : after & ~before)
+            {
+                if(result.addedCount == MAX_CHANGED_FEATURES) { result.refresh = true; return; }
+                result.added[result.addedCount++] = featureIndex(set, perspective, kingSquare, color, PieceType(piece), square);
+            }
+        }
+    }
+}
+
+Features::PackedPosition Features::pack(const BoardInfo& info)
+{
+    PackedPosition position = {};
+    BitBoard occupied = info.whitePieces | info.blackPieces;
+    position.occupied = occupied.board;
+
+    const BitBoard pieceBoards[6] = {info.pawns, info.knights, info.bishops, info.rooks, info.queens, info.kings};
+    int index = 0;
+    for(int square : occupied)
+    {
+        int piece = PAWN;
+        while(!pieceBoards[piece].get(square)) piece++;
+        int color = info.whitePieces.get(square) ? WHITE : BLACK;
+
+        position.pieces[index / 2] |= (color * 6 + piece) << (index % 2 * 4);
+        index++;
+    }
+
+    position.flags = info.whiteToMove | info.whiteCastleShort << 1 | info.whiteCastleLong << 2
+                   | info.blackCastleShort << 3 | info.blackCastleLong << 4;
+
+    BitBoard enPassant = info.whiteEnPassantTarget | info.blackEnPassantTarget;
+    position.enPassant = enPassant ? enPassant.lsb() : 64;
+    position.fiftyMoveRule = info.fiftyMoveRule;
+    position.plyCount = info.plyCount;
+    return position;
+}
+
+BoardInfo Features::unpack(const PackedPosition& position)
+{
+    BoardInfo info = unpackPieces(position);
+    info.key = ChessBoard::computeKey(info);
+    info.pawnKey = ChessBoard::computePawnKey(info);
+    Eval::refreshScores(info);
+    return info;
+}
+
+BoardInfo Features::unpackPieces(const PackedPosition& position)
+{
+    BoardInfo info;
+    BitBoard * pieceBoards[6] = {&info.pawns, &info.knights, &info.bishops, &info.rooks, &info.queens, &info.kings};
+
+    int index = 0;
+    for(int square : BitBoard(position.occupied))
+    {
+        int nibble = position.pieces[index / 2] >> (index % 2 * 4) & 15;
+        pieceBoards[nibble % 6]->set(square, true);
+        (nibble >= 6 ? info.whitePieces : info.blackPieces).set(square, true);
+        index++;
+    }
+
+    info.whiteToMove = position.flags & 1;
+    info.whiteCastleShort = position.flags & 2;
+    info.whiteCastleLong = position.flags & 4;
+    info.blackCastleShort = position.flags & 8;
+    info.blackCastleLong = position.flags & 16;
+
+    // the target belongs to the side that can capture, which is the side to move.
+    if(position.enPassant < 64)
+        (info.whiteToMove ? info.whiteEnPassantTarget : info.blackEnPassantTarget).set(position.enPassant, true);
+
+    info.fiftyMoveRule = position.fiftyMoveRule;
+    info.plyCount = position.plyCount;
+    return info;
+}
+
+void Features::extractBatch(const PackedPosition * positions, size_t count, FeatureSet set, uint32_t * features, uint8_t * counts, int threads)
+{
+    if(threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto extract = [=](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            BoardInfo info = unpackPieces(positions[i]);
+            for(Color perspective : {BLACK, WHITE})
+            {
+                size_t slot = i * 2 + perspective;
+                counts[slot] = activeFeatures(info, set, perspective, features + slot * MAX_ACTIVE_FEATURES);
+            }
+        }
+    };
+
+    // small batches are not worth starting threads for.
+    size_t chunk = std::max<size_t>(1024, (count + threads - 1) / threads);
+    if(threads == 1 || count <= chunk)
+    {
+        extract(0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for(size_t begin = chunk; begin < count; begin += chunk)
+        workers.emplace_back(extract, begin, std::min(count, begin + chunk));
+    // the calling thread takes the first chunk.
+    extract(0, std::min(count, chunk));
+
+    for(std::thread &worker : workers)
+        worker.join();
+}
@@ -0,0 +1,79 @@
+#ifndef FEATURESET_H
+#define FEATURESET_H
+
+#include <types.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace nnchesslib
+{
+    struct BoardInfo;
+
+    namespace Features
+    {
+        // Input feature sets, every active feature is a (piece, square) pair seen from one side.
+        // PIECE_SQUARE: 12 pieces * 64 squares = 768 features.
+        // HALF_KP: own king square * 10 pieces without kings * 64 squares, the features of NNUE.
+        // HALF_KA: own king square * 12 pieces * 64 squares.
+        enum FeatureSet
+        {
+            PIECE_SQUARE, HALF_KP, HALF_KA
+        };
+
+        // Every piece on the board is at most one feature per side.
+        const int MAX_ACTIVE_FEATURES = 32;
+        // A move adds and removes at most two features (castling moves two pieces), positions further apart need a refresh.
+        const int MAX_CHANGED_FEATURES = 4;
+
+        // Features added and removed from one side's perspective between two positions.
+        struct FeatureDiff
+        {
+            uint32_t added[MAX_CHANGED_FEATURES];
+            uint32_t removed[MAX_CHANGED_FEATURES];
+            int addedCount = 0;
+            int removedCount = 0;
+            // Set when the king square the features are relative to moved or too much changed,
+            // the features then have to be extracted again instead of applying the diff.
+            bool refresh = false;
+        };
+
+        // A position in 32 bytes, for storing and passing around many positions at once.
+        struct PackedPosition
+        {
+            U64 occupied;
+            // One nibble per occupied square in square order (low nibble first), color * 6 + piece type.
+            uint8_t pieces[16];
+            // Bit 0 is set when white is to move, bits 1-4 are the castling rights K, Q, k and q.
+            uint8_t flags;
+            // En passant target square, 64 when there is none.
+            uint8_t enPassant;
+            uint8_t fiftyMoveRule;
+            uint8_t reserved;
+            uint16_t plyCount;
+            uint16_t unused;
+        };
+        static_assert(sizeof(PackedPosition) == 32, "packed positions are 32 bytes");
+
+        // Returns the number of features of a feature set.
+        int featureCount(FeatureSet set);
+
+        // Writes the active features of a position from one side's perspective into features, which must have room
+        // for MAX_ACTIVE_FEATURES entries, and returns how many were written. Black looks at a flipped board.
+        int activeFeatures(const BoardInfo& info, FeatureSet set, Color perspective, uint32_t * features);
+
+        // Computes which features changed between a position and a position after it, usually its child.
+        void diff(const BoardInfo& parent, const BoardInfo& child, FeatureSet set, Color perspective, FeatureDiff& result);
+
+        PackedPosition pack(const BoardInfo& info);
+        BoardInfo unpack(const PackedPosition& position);
+        // Like unpack, but leaves the keys and the evaluation scores empty. Enough for extracting features or
+        // tensors, which only look at the pieces and the state flags.
+        BoardInfo unpackPieces(const PackedPosition& position);
+
+        // Extracts the features of many positions, split over a number of threads (0 uses all cores). The features of
+        // position i from perspective c go to features[(i * 2 + c) * MAX_ACTIVE_FEATURES], their count to counts[i * 2 + c].
+        void extractBatch(const PackedPosition * positions, size_t count, FeatureSet set, uint32_t * features, uint8_t * counts, int threads = 0);
+    }
+}
+
+#endif
@@ -8,6 +8,11 @@
 #include <bitset>
 #include <utils.h>
 #include <string>
+#include <zobrist.h>
+#include <bench.h>
+#include <search.h>
+#include <mate.h>
+#include <evaluate.h>
 
 using namespace nnchesslib;
 
@@ -19,6 +24,9 @@ void initAll()
 
     Rays::initRays();
     Attacks::initAllAttacks();
+    Zobrist::initKeys();
+    Eval::initTables();
+    Search::init();
 
     end = clock();
 
@@ -30,6 +38,64 @@ int main(int argc, char *argv[])
 {
     initAll();
 
+    if(argc > 1 && std::string(argv[1]) == "bench")
+    {
+        int depth = argc > 2 ? std::stoi(argv[2]) : 4;
+        Bench::runMovegenBench(depth);
+        return 0;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "searchbench")
+    {
+        int depth = argc > 2 ? std::stoi(argv[2]) : 5;
+        Bench::runSearchBench(depth);
+        return 0;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "threadbench")
+    {
+        int depth = argc > 2 ? std::stoi(argv[2]) : 6;
+        Bench::runThreadBench(depth);
+        return 0;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "selectivebench")
+    {
+        int depth = argc > 2 ? std::stoi(argv[2]) : 8;
+        Bench::runSelectiveBench(depth);
+        return 0;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "multipv")
+    {
+        int lines = argc > 2 ? std::stoi(argv[2]) : 3;
+        int depth = argc > 3 ? std::stoi(argv[3]) : 6;
+        Bench::runMultiPVBench(lines, depth);
+        return 0;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "nnuebench")
+    {
+        int depth = argc > 2 ? std::stoi(argv[2]) : 3;
+        Bench::runNNUEBench(depth);
+        return 0;
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "kernelcheck")
+    {
+        int rounds = argc > 2 ? std::stoi(argv[2]) : 10000;
+        return Bench::runKernelCheck(rounds) ? 0 : 1;
+    }
+
+    if(argc > 2 && std::string(argv[1]) == "mate")
+    {
+        int moves = argc > 3 ? std::stoi(argv[3]) : 3;
+        MateSolver solver;
+        MateResult result = solver.solve(ChessBoard(argv[2]), moves);
+        std::cout << result.toString() << " (" << result.nodes << " nodes)" << std::endl;
+        return 0;
+    }
+
     ChessBoard myBoard = ChessBoard();
 
     myBoard.pushFromUci("e2e4");
@@ -0,0 +1,270 @@
+// Mate.cpp | Depth-first proof-number search for forced mates.
+
+#include <mate.h>
+#include <movegen.h>
+#include <board.h>
+#include <move.h>
+#include <algorithm>
+
+using namespace nnchesslib;
+
+std::string MateResult::toString() const
+{
+    if(status == NO_MATE) return "no mate within " + std::to_string(moves);
+    if(status == MATE_UNKNOWN) return "no proof within " + std::to_string(nodes) + " nodes";
+
+    std::string output = "mate in " + std::to_string((line.size() + 1) / 2) + ":";
+    for(Move move : line)
+        output += " " + toUci(move);
+    return output;
+}
+
+MateSolver::MateSolver(size_t megabytes)
+{
+    table.resize(std::max((size_t)2, megabytes * 1024 * 1024 / sizeof(MateEntry)));
+}
+
+void MateSolver::clear()
+{
+    std::fill(table.begin(), table.end(), MateEntry());
+}
+
+U64 MateSolver::entryKey(U64 key, int movesLeft)
+{
+    // a key of 0 marks an empty entry.
+    return (key ^ ((U64)movesLeft * 0x9E3779B97F4A7C15ULL)) | 1;
+}
+
+void MateSolver::lookup(U64 key, uint32_t &proof, uint32_t &disproof)
+{
+    // two neighbouring entries form a bucket.
+    size_t index = (key % (table.size() / 2)) * 2;
+    for(size_t i = index; i < index + 2; i++)
+    {
+        if(table[i].key == key)
+        {
+            proof = table[i].proof;
+            disproof = table[i].disproof;
+            return;
+        }
+    }
+    proof = 1;
+    disproof = 1;
+}
+
+void MateSolver::store(U64 key, uint32_t proof, uint32_t disproof, U64 work)
+{
+    size_t index = (key % (table.size() / 2)) * 2;
+
+    // the same position is updated, otherwise the entry that took the least work to compute is replaced.
+    MateEntry * replace = &table[index];
+    if(table[index].key != key && (table[index + 1].key == key || table[index + 1].work < table[index].work))
+        replace = &table[index + 1];
+
+    replace->key = key;
+    replace->proof = proof;
+    replace->disproof = disproof;
+    replace->work = work;
+}
+
+MateResult MateSolver::solve(const ChessBoard& position, int moves, U64 maxNodes)
+{
+    board = position;
+    nodes = 0;
+    this->maxNodes = maxNodes;
+
+    MateResult result;
+    result.moves = moves;
+
+    // with quiet moves a longer mate is often proven before a shorter one, so the number of moves is increased
+    // one at a time. the smaller searches are cheap and fill the table for the larger ones.
+    for(int movesLeft = 1; movesLeft <= moves; movesLeft++)
+    {
+        mid(INFINITE_NUMBER, INFINITE_NUMBER, movesLeft, true);
+
+        uint32_t proof, disproof;
+        lookup(entryKey(board.getKey(), movesLeft), proof, disproof);
+
+        if(proof == 0)
+        {
+            result.status = MATE_FOUND;
+            // proving moves again while following the line gets its own node budget.
+            this->maxNodes = nodes + maxNodes;
+            extractLine(movesLeft, result.line);
+            break;
+        }
+        if(disproof != 0) break;
+        if(movesLeft == moves) result.status = NO_MATE;
+    }
+
+    result.nodes = nodes;
+    return result;
+}
+
+bool MateSolver::sideToMoveInCheck()
+{
+    return board.kingInCheck(board.boardinfo.whiteToMove ? WHITE : BLACK);
+}
+
+void MateSolver::generateMoves(int movesLeft, bool orNode, MoveList &moves)
+{
+    if(orNode)
+    {
+        // only a check can mate with the last move, before that quiet moves can set up the mate.
+        if(movesLeft == 1)
+            genCheckingMoves(board, moves);
+        else if(movesLeft > 1)
+            moves = genLegalMoves(board);
+    }
+    else if(sideToMoveInCheck())
+        genEvasions(board, moves);
+    else
+        moves = genLegalMoves(board);
+}
+
+void MateSolver::mid(uint32_t proofThreshold, uint32_t disproofThreshold, int movesLeft, bool orNode)
+{
+    nodes++;
+    U64 startNodes = nodes;
+    U64 key = entryKey(board.getKey(), movesLeft);
+
+    MoveList moves;
+    generateMoves(movesLeft, orNode, moves);
+
+    // an attacker without moves has no mate, a defender without moves is mated when in check and
+    // stalemated otherwise.
+    if(moves.empty())
+    {
+        if(!orNode && sideToMoveInCheck()) store(key, 0, INFINITE_NUMBER, 1);
+        else store(key, INFINITE_NUMBER, 0, 1);
+        return;
+    }
+
+    int childMovesLeft = orNode ? movesLeft - 1 : movesLeft;
+
+    U64 childKeys[256];
+    bool repetitions[256];
+    for(int i = 0; i < moves.size(); i++)
+    {
+        board.pushMove(moves[i]);
+        childKeys[i] = entryKey(board.getKey(), childMovesLeft);
+        repetitions[i] = board.isRepetition();
+        board.popMove();
+    }
+
+    while(true)
+    {
+        // at an attacker node the cheapest move to prove decides the proof number, and all moves have to be
+        // disproven, at a defender node it is the other way around.
+        U64 proofSum = 0, disproofSum = 0;
+        uint32_t minProof = INFINITE_NUMBER, minDisproof = INFINITE_NUMBER;
+        uint32_t secondBest = INFINITE_NUMBER;
+        int best = 0;
+
+        for(int i = 0; i < moves.size(); i++)
+        {
+            uint32_t proof, disproof;
+            // repeating a position is a draw, so it never leads to a mate.
+            if(repetitions[i])
+            {
+                proof = INFINITE_NUMBER;
+                disproof = 0;
+            }
+            else
+                lookup(childKeys[i], proof, disproof);
+
+            proofSum += proof;
+            disproofSum += disproof;
+
+            uint32_t value = orNode ? proof : disproof;
+            if(value < (orNode ? minProof : minDisproof))
+            {
+                secondBest = orNode ? minProof : minDisproof;
+                best = i;
+            }
+            else if(value < secondBest)
+                secondBest = value;
+
+            minProof = std::min(minProof, proof);
+            minDisproof = std::min(minDisproof, disproof);
+        }
+
+        uint32_t proof = orNode ? minProof : (uint32_t)std::min<U64>(proofSum, INFINITE_NUMBER);
+        uint32_t disproof = orNode ? (uint32_t)std::min<U64>(disproofSum, INFINITE_NUMBER) : minDisproof;
+
+        if(proof >= proofThreshold || disproof >= disproofThreshold || nodes >= maxNodes)
+        {
+            store(key, proof, disproof, nodes - startNodes + 1);
+            return;
+        }
+
+        // the best child is searched until it becomes worse than the second best, or until this node reaches its thresholds.
+        uint32_t childProof, childDisproof;
+        lookup(childKeys[best], childProof, childDisproof);
+
+        uint32_t childProofThreshold, childDisproofThreshold;
+        if(orNode)
+        {
+            childProofThreshold = std::min(proofThreshold, secondBest + 1);
+            childDisproofThreshold = (uint32_t)std::min<U64>((U64)disproofThreshold - disproof + childDisproof, INFINITE_NUMBER);
+        }
+        else
+        {
+            childDisproofThreshold = std::min(disproofThreshold, secondBest + 1);
+            childProofThreshold = (uint32_t)std::min<U64>((U64)proofThreshold - proof + childProof, INFINITE_NUMBER);
+        }
+
+        board.pushMove(moves[best]);
+        mid(childProofThreshold, childDisproofThreshold, childMovesLeft, !orNode);
+        board.popMove();
+    }
+}
+
+void MateSolver::extractLine(int movesLeft, std::vector<Move> &line)
+{
+    bool orNode = true;
+
+    while(true)
+    {
+        MoveList moves;
+        generateMoves(movesLeft, orNode, moves);
+
+        // a defender without moves is mated, that is where the line ends.
+        if(moves.empty()) return;
+
+        int childMovesLeft = orNode ? movesLeft - 1 : movesLeft;
+        Move next = MOVE_NONE;
+
+        // a proven move that is still in the table is taken first. proofs can have been replaced in a full
+        // table though, then the moves are proven once more.
+        for(int pass = 0; pass < 2 && next == MOVE_NONE; pass++)
+        {
+            for(Move move : moves)
+            {
+                board.pushMove(move);
+                uint32_t proof, disproof;
+                lookup(entryKey(board.getKey(), childMovesLeft), proof, disproof);
+
+                if(pass == 1 && proof != 0 && !board.isRepetition())
+                {
+                    mid(INFINITE_NUMBER, INFINITE_NUMBER, childMovesLeft, !orNode);
+                    lookup(entryKey(board.getKey(), childMovesLeft), proof, disproof);
+                }
+                board.popMove();
+
+                if(proof == 0)
+                {
+                    next = move;
+                    break;
+                }
+            }
+        }
+
+        if(next == MOVE_NONE) return;
+
+        line.push_back(next);
+        board.pushMove(next);
+        movesLeft = childMovesLeft;
+        orNode = !orNode;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef MATE_H
+#define MATE_H
+
+#include <board.h>
+#include <move.h>
+#include <movegen.h>
+#include <types.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nnchesslib
+{
+    enum MateStatus
+    {
+        MATE_FOUND, NO_MATE, MATE_UNKNOWN
+    };
+
+    struct MateResult
+    {
+        // NO_MATE means it is proven there is no mate within the given number of moves,
+        // MATE_UNKNOWN that the node limit was reached before a proof either way.
+        MateStatus status = MATE_UNKNOWN;
+        // Number of moves the mate was searched for.
+        int moves = 0;
+        // The mating line, ending in checkmate. The defending moves are not always the longest defence.
+        std::vector<Move> line;
+        U64 nodes = 0;
+
+        // e.g. "mate in 2: d1d8 e8d8 f1d1" or "no mate within 3".
+        std::string toString() const;
+    };
+
+    // Proof and disproof number of a position, from the attacker's point of view.
+    struct MateEntry
+    {
+        U64 key = 0;
+        uint32_t proof = 0;
+        uint32_t disproof = 0;
+        // Nodes spent on the position, positions that took more work are kept when the table is full.
+        U64 work = 0;
+    };
+
+    // Depth-first proof-number search (df-pn) for forced mates. The attacker plays any move, except for the last
+    // one which has to be a check, and the defender answers checks with evasions only. A position is proven (proof number 0) when it is a mate and
+    // disproven (disproof number 0) when there is no mate within the remaining moves. df-pn always expands the
+    // position that is cheapest to prove or disprove, and only returns to the parent when that becomes more
+    // expensive than its second best sibling.
+    class MateSolver
+    {
+        public:
+            static const uint32_t INFINITE_NUMBER = 1u << 30;
+
+            // The proof numbers are kept in a hash table of the given size in megabytes, it is kept between
+            // solve() calls because positions repeat a lot between puzzles.
+            explicit MateSolver(size_t megabytes = 16);
+
+            // Searches a forced mate for the side to move in at most the given number of its moves.
+            MateResult solve(const ChessBoard& board, int moves, U64 maxNodes = 10000000);
+
+            void clear();
+
+        private:
+            std::vector<MateEntry> table;
+            ChessBoard board;
+            U64 nodes = 0;
+            U64 maxNodes = 0;
+
+            // Proofs depend on the number of attacker moves left, so that number is part of the key.
+            static U64 entryKey(U64 key, int movesLeft);
+
+            // Returns the proof and disproof number of a position, 1 and 1 for positions that are not in the table.
+            void lookup(U64 key, uint32_t &proof, uint32_t &disproof);
+            void store(U64 key, uint32_t proof, uint32_t disproof, U64 work);
+
+            // Searches the position on the board until its proof number reaches proofThreshold or its disproof
+            // number reaches disproofThreshold. At an attacker node (orNode) one proven move is enough, at a
+            // defender node all moves have to be proven.
+            void mid(uint32_t proofThreshold, uint32_t disproofThreshold, int movesLeft, bool orNode);
+
+            // The moves of the side to move: all legal moves, or checks only for the last attacker move
+            // and evasions only for a defender in check.
+            void generateMoves(int movesLeft, bool orNode, MoveList &moves);
+            bool sideToMoveInCheck();
+
+            // Follows proven moves from the position on the board to the mate.
+            void extractLine(int movesLeft, std::vector<Move> &line);
+    };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define MOVE_H
 
 #include <types.h>
+#include <cstdint>
 
 namespace nnchesslib
 {
@@ -10,20 +11,73 @@ namespace nnchesslib
         NORMAL, PROMOTION, ENPASSANT, CASTLING
     };
 
-    typedef unsigned int Move;
+    typedef uint16_t Move;
     //0-5 -> to
     //6-11 -> from
     //12-13 -> promotionpiecetype (PieceType-1)
     //14-15 -> (0) no special (1) promotion (2) en passant (3) castle
 
-    int from_Square(Move m);
-    int to_Square(Move m);
-    PieceType movePromotionType(Move m);
-    MoveType moveType(Move m);
+    // createMove(A1, A1) can never be a real move, so 0 is used for 'no move'.
+    const Move MOVE_NONE = 0;
 
-    Move createMove(int from, int to);
-    Move createMove(int from, int to, PieceType p);
-    Move createMove(int from, int to, MoveType mt);
+    // A move together with a score used for move ordering, higher scores are searched first.
+    struct ExtMove
+    {
+        Move move;
+        int16_t score;
+
+        constexpr operator Move() const { return move; }
+    };
+
+    // These are called for every generated move, so they are defined here to allow inlining.
+    constexpr inline int from_Square(Move m)
+    {
+        return (m >> 6) & 0x3f;
+    }
+
+    constexpr inline int to_Square(Move m)
+    {
+        return (m & 0x3f);
+    }
+
+    constexpr inline PieceType movePromotionType(Move m)
+    {
+        return PieceType(((m >> 12) & 3) + KNIGHT);
+    }
+
+    constexpr inline MoveType moveType(Move m)
+    {
+        return MoveType(((m >> 14) & 3) + (int)NORMAL);
+    }
+
+    constexpr inline Move createMove(int from, int to)
+    {
+        return (from << 6) + to;
+    }
+
+    constexpr inline Move createMove(int from, int to, PieceType p)
+    {
+        return (PROMOTION << 14) + ((p-KNIGHT) << 12) + (from << 6) + to;
+    }
+
+    constexpr inline Move createMove(int from, int to, MoveType mt)
+    {
+        return (mt << 14) + (from << 6) + to;
+    }
+
+    // Returns the move as seen from the other side of the board (e2e4 -> e7e5), flags are kept.
+    // flipping a square vertically is sq ^ 56, so both squares can be flipped with one xor.
+    constexpr inline Move flipMove(Move m)
+    {
+        return m ^ ((56 << 6) | 56);
+    }
+
+    // Returns the move mirrored over the d/e file divide (b1c3 -> g1f3), flags are kept.
+    // mirroring a square horizontally is sq ^ 7.
+    constexpr inline Move mirrorMove(Move m)
+    {
+        return m ^ ((7 << 6) | 7);
+    }
 
     std::string toUci(Move m);
 
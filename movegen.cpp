@@ -6,30 +6,32 @@
 
 using namespace nnchesslib;
 
-MoveList nnchesslib::genLegalMoves(ChessBoard board)
+MoveList nnchesslib::genLegalMoves(ChessBoard& board)
 {
     MoveList pseudoLegalMoves;
     MoveList legalMoves;
 
     genPseudoLegalMoves(board, pseudoLegalMoves);
+
+    Color boardTurn = BLACK;
+    if(board.getWhiteToMove()) boardTurn = WHITE;
     
+    // the moves are made on the board itself and undone again, instead of copying the board for every move.
     for(auto move : pseudoLegalMoves)
     {
-        ChessBoard temp = board;
-        temp.pushMove(move);
-
-        Color boardTurn = BLACK;
-        if(board.getWhiteToMove()) boardTurn = WHITE;
+        board.pushMove(move);
 
-        if(!temp.kingInCheck(boardTurn)) 
+        if(!board.kingInCheck(boardTurn)) 
         {
             legalMoves.push_back(move);
         }
+
+        board.popMove();
     }
     return legalMoves;
 }
 
-void nnchesslib::genPseudoLegalMoves(ChessBoard board, MoveList& moveList)
+void nnchesslib::genPseudoLegalMoves(ChessBoard& board, MoveList& moveList)
 {
     BitBoard blockers = board.getBlockers();
     
@@ -39,7 +41,237 @@ void nnchesslib::genPseudoLegalMoves(ChessBoard board, MoveList& moveList)
         genBlackMoves(board, moveList, blockers);
 }
 
-void nnchesslib::genWhiteMoves(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genCaptureMoves(ChessBoard& board, MoveList& moveList)
+{
+    BitBoard blockers = board.getBlockers();
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    BitBoard theirPieces = board.getBoard(board.getOppositeColor(us));
+
+    // quiet promotions are included as well, they change the material balance just like captures.
+    if(us == WHITE)
+    {
+        genWhitePawnCaptures(board, moveList, blockers);
+
+        BitBoard promotedPawns = (board.getBoard(WHITE, PAWN) << 8) & ~blockers & rank_bb[RANK_8];
+        for(int index : promotedPawns)
+            genPromotions(index - 8, moveList, WHITE, BitBoard((U64)1 << index));
+    }
+    else
+    {
+        genBlackPawnCaptures(board, moveList, blockers);
+
+        BitBoard promotedPawns = (board.getBoard(BLACK, PAWN) >> 8) & ~blockers & rank_bb[RANK_1];
+        for(int index : promotedPawns)
+            genPromotions(index + 8, moveList, BLACK, BitBoard((U64)1 << index));
+    }
+
+    for(PieceType piece : {KNIGHT, KING})
+    {
+        for(int index : board.getBoard(us, piece))
+        {
+            BitBoard captures = BitBoard(Attacks::getNonSlidingAttacks(index, us, piece)) & theirPieces;
+            for(int captureIndex : captures)
+                moveList.push_back(createMove(index, captureIndex));
+        }
+    }
+
+    for(PieceType piece : {BISHOP, ROOK, QUEEN})
+    {
+        for(int index : board.getBoard(us, piece))
+        {
+            BitBoard captures = BitBoard(Attacks::getSlidingAttacks(index, piece, blockers.board)) & theirPieces;
+            for(int captureIndex : captures)
+                moveList.push_back(createMove(index, captureIndex));
+        }
+    }
+}
+
+void nnchesslib::genQuietMoves(ChessBoard& board, MoveList& moveList)
+{
+    BitBoard blockers = board.getBlockers();
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    BitBoard empty = ~blockers;
+
+    if(us == WHITE)
+    {
+        BitBoard pushes = (board.getBoard(WHITE, PAWN) << 8) & empty & ~BitBoard(rank_bb[RANK_8]);
+        for(int index : pushes)
+            moveList.push_back(createMove(index - 8, index));
+        genWhiteDoublePawnMoves(board, moveList, blockers);
+    }
+    else
+    {
+        BitBoard pushes = (board.getBoard(BLACK, PAWN) >> 8) & empty & ~BitBoard(rank_bb[RANK_1]);
+        for(int index : pushes)
+            moveList.push_back(createMove(index + 8, index));
+        genBlackDoublePawnMoves(board, moveList, blockers);
+    }
+
+    for(PieceType piece : {KNIGHT, KING})
+    {
+        for(int index : board.getBoard(us, piece))
+        {
+            BitBoard quiets = BitBoard(Attacks::getNonSlidingAttacks(index, us, piece)) & empty;
+            for(int quietIndex : quiets)
+                moveList.push_back(createMove(index, quietIndex));
+        }
+    }
+
+    for(PieceType piece : {BISHOP, ROOK, QUEEN})
+    {
+        for(int index : board.getBoard(us, piece))
+        {
+            BitBoard quiets = BitBoard(Attacks::getSlidingAttacks(index, piece, blockers.board)) & empty;
+            for(int quietIndex : quiets)
+                moveList.push_back(createMove(index, quietIndex));
+        }
+    }
+
+    genCastlingMoves(board, moveList, us, blockers);
+}
+
+void nnchesslib::genEvasions(ChessBoard& board, MoveList& moveList)
+{
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    BitBoard blockers = board.getBlockers();
+    int kingSquare = board.getBoard(us, KING).lsb();
+    BitBoard checkers = board.attackersTo(kingSquare, blockers) & board.getBoard(board.getOppositeColor(us));
+
+    // against a single check the checker can also be captured or the line to it blocked, against a double check only the king can move.
+    BitBoard targets;
+    if(checkers.popcount() == 1)
+    {
+        int checkerSquare = checkers.lsb();
+        targets = checkers;
+
+        PieceType checker = board.getPieceTypeOnSquare(checkerSquare);
+        if(checker == BISHOP || checker == ROOK || checker == QUEEN)
+        {
+            // the squares between two squares on a line are where the rays from both squares along that line meet.
+            bool straight = checkerSquare / 8 == kingSquare / 8 || checkerSquare % 8 == kingSquare % 8;
+            PieceType line = straight ? ROOK : BISHOP;
+            targets |= BitBoard(Attacks::getSlidingAttacks(kingSquare, line, checkers.board))
+                & BitBoard(Attacks::getSlidingAttacks(checkerSquare, line, (U64)1 << kingSquare));
+        }
+    }
+
+    MoveList pseudoLegalMoves;
+    genPseudoLegalMoves(board, pseudoLegalMoves);
+
+    for(Move move : pseudoLegalMoves)
+    {
+        int from = from_Square(move);
+        int to = to_Square(move);
+
+        // the en passant target is behind the captured pawn, the pawn itself can be the checker.
+        bool capturesChecker = moveType(move) == ENPASSANT && checkers.get((from / 8) * 8 + to % 8);
+        if(from != kingSquare && !targets.get(to) && !capturesChecker) continue;
+
+        board.pushMove(move);
+        if(!board.kingInCheck(us))
+            moveList.push_back(move);
+        board.popMove();
+    }
+}
+
+void nnchesslib::genCheckingMoves(ChessBoard& board, MoveList& moveList)
+{
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    Color them = board.getOppositeColor(us);
+    BitBoard blockers = board.getBlockers();
+    int kingSquare = board.getBoard(them, KING).lsb();
+
+    // the squares from where each piece type would attack the enemy king.
+    BitBoard checkSquares[6];
+    checkSquares[PAWN] = Attacks::getNonSlidingAttacks(kingSquare, them, PAWN);
+    checkSquares[KNIGHT] = Attacks::getNonSlidingAttacks(kingSquare, them, KNIGHT);
+    checkSquares[BISHOP] = Attacks::getSlidingAttacks(kingSquare, BISHOP, blockers.board);
+    checkSquares[ROOK] = Attacks::getSlidingAttacks(kingSquare, ROOK, blockers.board);
+    checkSquares[QUEEN] = checkSquares[BISHOP] | checkSquares[ROOK];
+    checkSquares[KING] = BitBoard();
+
+    // moving one of our pieces off a line to the enemy king can uncover a check by a piece behind it.
+    BitBoard discoverers = BitBoard(Attacks::getSlidingAttacks(kingSquare, QUEEN, blockers.board)) & board.getBoard(us);
+
+    MoveList pseudoLegalMoves;
+    genPseudoLegalMoves(board, pseudoLegalMoves);
+
+    for(Move move : pseudoLegalMoves)
+    {
+        PieceType piece = board.getPieceTypeOnSquare(from_Square(move));
+
+        // promotions, castling and en passant change more than one square, those are always tried.
+        bool candidate = moveType(move) != NORMAL || checkSquares[piece].get(to_Square(move)) || discoverers.get(from_Square(move));
+        if(!candidate) continue;
+
+        board.pushMove(move);
+        if(!board.kingInCheck(us) && board.kingInCheck(them))
+            moveList.push_back(move);
+        board.popMove();
+    }
+}
+
+bool nnchesslib::isPseudoLegal(ChessBoard& board, Move move)
+{
+    if(move == MOVE_NONE) return false;
+
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    int from = from_Square(move);
+    int to = to_Square(move);
+    MoveType type = moveType(move);
+
+    BitBoard ourPieces = board.getBoard(us);
+    BitBoard theirPieces = board.getBoard(board.getOppositeColor(us));
+    BitBoard blockers = ourPieces | theirPieces;
+
+    if(!ourPieces.get(from) || ourPieces.get(to)) return false;
+    // only promotions use the promotion piece bits, the generator leaves them empty for every other move.
+    if(type != PROMOTION && movePromotionType(move) != KNIGHT) return false;
+
+    // castling has the most conditions, the generator already checks all of them.
+    if(type == CASTLING)
+    {
+        MoveList castlingMoves;
+        genCastlingMoves(board, castlingMoves, us, blockers);
+        for(Move castlingMove : castlingMoves)
+            if(castlingMove == move) return true;
+        return false;
+    }
+
+    PieceType piece = board.getPieceTypeOnSquare(from);
+
+    if(piece != PAWN)
+    {
+        if(type != NORMAL) return false;
+
+        U64 attacks = (piece == KNIGHT || piece == KING)
+            ? Attacks::getNonSlidingAttacks(from, us, piece)
+            : Attacks::getSlidingAttacks(from, piece, blockers.board);
+        return BitBoard(attacks).get(to);
+    }
+
+    BitBoard pawnAttacks = Attacks::getNonSlidingAttacks(from, us, PAWN);
+
+    if(type == ENPASSANT)
+    {
+        BitBoard enPassantTarget = us == WHITE ? board.boardinfo.whiteEnPassantTarget : board.boardinfo.blackEnPassantTarget;
+        return (pawnAttacks & enPassantTarget).get(to);
+    }
+
+    // a pawn reaching the last rank has to promote, and only then.
+    BitBoard lastRank = BitBoard(us == WHITE ? rank_bb[RANK_8] : rank_bb[RANK_1]);
+    if((type == PROMOTION) != lastRank.get(to)) return false;
+
+    if(theirPieces.get(to)) return pawnAttacks.get(to);
+
+    int forward = us == WHITE ? 8 : -8;
+    if(to == from + forward) return true;
+
+    int startRank = us == WHITE ? 1 : 6;
+    return from / 8 == startRank && to == from + 2 * forward && !blockers.get(from + forward);
+}
+
+void nnchesslib::genWhiteMoves(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
     genWhiteSinglePawnMoves(board,moveList, blockers);
     genWhiteDoublePawnMoves(board,moveList, blockers);
@@ -52,7 +284,7 @@ void nnchesslib::genWhiteMoves(ChessBoard board, MoveList& moveList, BitBoard bl
     genCastlingMoves(board,moveList, WHITE, blockers);
 }
 
-void nnchesslib::genBlackMoves(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genBlackMoves(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
     genBlackSinglePawnMoves(board,moveList, blockers);
     genBlackDoublePawnMoves(board,moveList, blockers);
@@ -65,62 +297,41 @@ void nnchesslib::genBlackMoves(ChessBoard board, MoveList& moveList, BitBoard bl
     genCastlingMoves(board,moveList, BLACK, blockers);
 }
 
-void nnchesslib::genWhiteSinglePawnMoves(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genWhiteSinglePawnMoves(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
     BitBoard pawns = board.getBoard(WHITE, PAWN);
     // making a move and checking if pawns have been blocked
-    BitBoard pawnsMoved = (pawns.board << 8) & ~blockers.board;
+    BitBoard pawnsMoved = (pawns << 8) & ~blockers;
 
-    BitBoard promotedPawns = pawnsMoved.board & rank_bb[RANK_8];
-    // make a copy because we still want to use promotedpawns bitboard after lsb has been popped.
-    BitBoard promotedPawnsCopy = promotedPawns;
-    int promotedPawnCount = __builtin_popcountll(promotedPawns.board);
+    BitBoard promotedPawns = pawnsMoved & rank_bb[RANK_8];
 
-    for(int _ =  0; _ < promotedPawnCount; _++)
+    for(int index : promotedPawns)
     {
-        int index = popLsb(promotedPawnsCopy.board);
         // genPromotions function only works for a single index in the bitboard.
-        BitBoard singlePawnBoard;
-        singlePawnBoard.set(index, true);
-
-        genPromotions(index - 8, moveList, WHITE, singlePawnBoard);
+        genPromotions(index - 8, moveList, WHITE, BitBoard((U64)1 << index));
     }
 
-    pawnsMoved.board &= ~rank_bb[RANK_8];
-
-    int validPawnCount = __builtin_popcountll(pawnsMoved.board);
+    pawnsMoved &= ~BitBoard(rank_bb[RANK_8]);
 
-    for(int _ = 0; _ < validPawnCount; _++)
+    for(int index : pawnsMoved)
     {
-        // finding current index of pawn.
-        int index = popLsb(pawnsMoved.board);
-
-        if (index == -1)
-            continue;
         // adding to pseudo legal movelist. 
         Move move = createMove(index - 8, index);
         moveList.push_back(move);
     }
 }
 
-void nnchesslib::genWhiteDoublePawnMoves(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genWhiteDoublePawnMoves(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
     // targetting pawns that are on the second rank. These are the only pawns that can move twice.
-    BitBoard unmovedPawns = board.getBoard(WHITE, PAWN).board & rank_bb[RANK_2];
+    BitBoard unmovedPawns = board.getBoard(WHITE, PAWN) & rank_bb[RANK_2];
     // moving pawns once to check if they are blocked:
-    BitBoard firstMove = (unmovedPawns.board << 8) & ~blockers.board;
+    BitBoard firstMove = (unmovedPawns << 8) & ~blockers;
     // moving again:
-    BitBoard secondMove = (firstMove.board << 8) & ~blockers.board;
-
-    int validPawnCount = __builtin_popcountll(secondMove.board);
+    BitBoard secondMove = (firstMove << 8) & ~blockers;
 
-    for(int _ = 0; _ < validPawnCount; _++)
+    for(int index : secondMove)
     {
-        // finding current index of pawn.
-        int index = popLsb(secondMove.board);
-
-        if (index == -1)
-            continue;
         // adding to pseudo legal movelist. 
         Move move = createMove(index - 16, index);
         moveList.push_back(move);
@@ -128,261 +339,161 @@ void nnchesslib::genWhiteDoublePawnMoves(ChessBoard board, MoveList& moveList, B
 }
 
 
-void nnchesslib::genWhitePawnCaptures(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genWhitePawnCaptures(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
     // getting board for white pawns.
-    BitBoard pawns = board.getBoard(WHITE, PAWN).board;
+    BitBoard pawns = board.getBoard(WHITE, PAWN);
     BitBoard black = board.getBoard(BLACK);
-    // counting the amount of white pawns.
-    int pawnCount = __builtin_popcountll(pawns.board);
 
-    for(int _ = 0; _ < pawnCount; _++)
+    for(int index : pawns)
     {
-        // getting the index of a specific pawn and removing it from the board.
-        int index = popLsb(pawns.board);
-
-        if (index == -1)
-            continue;
-        
+        BitBoard attacks = Attacks::getNonSlidingAttacks(index, WHITE, PAWN);
         // getting attacks and comparing to black pieces.
-        BitBoard pawnAttacks = Attacks::getNonSlidingAttacks(index, WHITE, PAWN) & black.board;
+        BitBoard pawnAttacks = attacks & black;
 
         // getting en passant move by looking at if a white pawn is attacking a predefined en passant square ('under' the pawn, actually it is above the pawn because it is a black pawn)
-        BitBoard enPassant = Attacks::getNonSlidingAttacks(index, WHITE, PAWN) & board.boardinfo.whiteEnPassantTarget.board;
-        if(enPassant.board)
+        BitBoard enPassant = attacks & board.boardinfo.whiteEnPassantTarget;
+        if(enPassant)
         {
-            int epIndex = popLsb(enPassant.board);
-
-            Move enPassantMove = createMove(index, epIndex, ENPASSANT);
+            Move enPassantMove = createMove(index, enPassant.lsb(), ENPASSANT);
             moveList.push_back(enPassantMove);
         }
 
-        BitBoard promotedPawns = pawnAttacks.board & rank_bb[RANK_8];
+        BitBoard promotedPawns = pawnAttacks & rank_bb[RANK_8];
         // if there is an attack generate promotion moves.
-        if(promotedPawns.board)
+        if(promotedPawns)
             genPromotions(index, moveList, WHITE, promotedPawns);
 
         // removing attacks on the eighth rank to prevent non promotions moves from being added.
-        pawnAttacks.board &= ~rank_bb[RANK_8];
-        if(pawnAttacks.board){
-            // getting the amount of pieces a pawn is attacking.
-            int attackCount = __builtin_popcountll(pawnAttacks.board);
-            
-            for(int num = 0; num < attackCount; num++)
-            {
-                // getting the index of the attacked pawn/piece from black.
-                int attackIndex = popLsb(pawnAttacks.board);
-
-                if (attackIndex == -1)
-                    continue;
-                // generating a move with our pawn index and the index of blacks attacked pawn/piece.
-                Move move = createMove(index, attackIndex);
-                moveList.push_back(move);
-            }
+        pawnAttacks &= ~BitBoard(rank_bb[RANK_8]);
+        for(int attackIndex : pawnAttacks)
+        {
+            // generating a move with our pawn index and the index of blacks attacked pawn/piece.
+            Move move = createMove(index, attackIndex);
+            moveList.push_back(move);
         }
     }
 }
 
-void nnchesslib::genBlackSinglePawnMoves(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genBlackSinglePawnMoves(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
     BitBoard pawns = board.getBoard(BLACK, PAWN);
     // making a move and checking if pawns have been blocked
-    BitBoard pawnsMoved = (pawns.board >> 8) & ~blockers.board;
+    BitBoard pawnsMoved = (pawns >> 8) & ~blockers;
 
-    BitBoard promotedPawns = pawnsMoved.board & rank_bb[RANK_1];
-    // make a copy because we still want to use promotedpawns bitboard after lsb has been popped.
-    BitBoard promotedPawnsCopy = promotedPawns;
-    int promotedPawnCount = __builtin_popcountll(promotedPawns.board);
+    BitBoard promotedPawns = pawnsMoved & rank_bb[RANK_1];
 
-    for(int _ =  0; _ < promotedPawnCount; _++)
+    for(int index : promotedPawns)
     {
-        int index = popLsb(promotedPawnsCopy.board);
         // genPromotions function only works for a single index in the bitboard.
-        BitBoard singlePawnBoard;
-        singlePawnBoard.set(index, true);
-
-        genPromotions(index + 8, moveList, BLACK, singlePawnBoard);
+        genPromotions(index + 8, moveList, BLACK, BitBoard((U64)1 << index));
     }
 
-    pawnsMoved.board &= ~rank_bb[RANK_1];
+    pawnsMoved &= ~BitBoard(rank_bb[RANK_1]);
 
-    int validPawnCount = __builtin_popcountll(pawnsMoved.board);
-
-    for(int _ = 0; _ < validPawnCount; _++)
+    for(int index : pawnsMoved)
     {
-        // finding current index of pawn.
-        int index = popLsb(pawnsMoved.board);
-
-        if (index == -1)
-            continue;
         // adding to pseudo legal movelist. 
         Move move = createMove(index + 8, index);
         moveList.push_back(move);
     }
 }
 
-void nnchesslib::genBlackDoublePawnMoves(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genBlackDoublePawnMoves(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
-    // targetting pawns that are on the second rank. These are the only pawns that can move twice.
-    BitBoard unmovedPawns = board.getBoard(BLACK, PAWN).board & rank_bb[RANK_7];
+    // targetting pawns that are on the seventh rank. These are the only pawns that can move twice.
+    BitBoard unmovedPawns = board.getBoard(BLACK, PAWN) & rank_bb[RANK_7];
     // moving pawns once to check if they are blocked:
-    BitBoard firstMove = (unmovedPawns.board >> 8) & ~blockers.board;
+    BitBoard firstMove = (unmovedPawns >> 8) & ~blockers;
     // moving again:
-    BitBoard secondMove = (firstMove.board >> 8) & ~blockers.board;
-
-    int validPawnCount = __builtin_popcountll(secondMove.board);
+    BitBoard secondMove = (firstMove >> 8) & ~blockers;
 
-    for(int _ = 0; _ < validPawnCount; _++)
+    for(int index : secondMove)
     {
-        // finding current index of pawn.
-        int index = popLsb(secondMove.board);
-
-        if (index == -1)
-            continue;
         // adding to pseudo legal movelist. 
         Move move = createMove(index + 16, index);
         moveList.push_back(move);
     }
 }
 
-void nnchesslib::genBlackPawnCaptures(ChessBoard board, MoveList& moveList, BitBoard blockers)
+void nnchesslib::genBlackPawnCaptures(ChessBoard& board, MoveList& moveList, BitBoard blockers)
 {
     // getting board for black pawns.
-    BitBoard pawns = board.getBoard(BLACK, PAWN).board;
+    BitBoard pawns = board.getBoard(BLACK, PAWN);
     BitBoard white = board.getBoard(WHITE);
-    // counting the amount of white pawns.
-    int pawnCount = __builtin_popcountll(pawns.board);
 
-    for(int _ = 0; _ < pawnCount; _++)
+    for(int index : pawns)
     {
-        // getting the index of a specific pawn and removing it from the board.
-        int index = popLsb(pawns.board);
-
-        if (index == -1)
-            continue;
-        
+        BitBoard attacks = Attacks::getNonSlidingAttacks(index, BLACK, PAWN);
         // getting attacks and comparing to white pieces.
-        BitBoard pawnAttacks = Attacks::getNonSlidingAttacks(index, BLACK, PAWN) & white.board;
-        // checking whether there is an attack on the eighth rank.
+        BitBoard pawnAttacks = attacks & white;
 
-        // getting en passant move by looking at if a white pawn is attacking a predefined en passant square ('above' the pawn, actually it is above the pawn because it is a white pawn)
-        BitBoard enPassant = Attacks::getNonSlidingAttacks(index, BLACK, PAWN) & board.boardinfo.blackEnPassantTarget.board;
-        if(enPassant.board)
+        // getting en passant move by looking at if a black pawn is attacking a predefined en passant square ('above' the pawn, actually it is under the pawn because it is a white pawn)
+        BitBoard enPassant = attacks & board.boardinfo.blackEnPassantTarget;
+        if(enPassant)
         {
-            int epIndex = popLsb(enPassant.board);
-
-            Move enPassantMove = createMove(index, epIndex, ENPASSANT);
+            Move enPassantMove = createMove(index, enPassant.lsb(), ENPASSANT);
             moveList.push_back(enPassantMove);
         }
 
-        BitBoard promotedPawns = pawnAttacks.board & rank_bb[RANK_1];
+        BitBoard promotedPawns = pawnAttacks & rank_bb[RANK_1];
         // if there is an attack generate promotion moves.
-        if(promotedPawns.board)
+        if(promotedPawns)
             genPromotions(index, moveList, BLACK, promotedPawns);
 
-        // removing attacks on the eighth rank to prevent non promotions moves from being added.
-        pawnAttacks.board &= ~rank_bb[RANK_1];
-        if(pawnAttacks.board){
-            // getting the amount of pieces a pawn is attacking.
-            int attackCount = __builtin_popcountll(pawnAttacks.board);
-            
-            for(int num = 0; num < attackCount; num++)
-            {
-                // getting the index of the attacked pawn/piece from black.
-                int attackIndex = popLsb(pawnAttacks.board);
-
-                if (attackIndex == -1)
-                    continue;
-                // generating a move with our pawn index and the index of blacks attacked pawn/piece.
-                Move move = createMove(index, attackIndex);
-                moveList.push_back(move);
-            }
+        // removing attacks on the first rank to prevent non promotions moves from being added.
+        pawnAttacks &= ~BitBoard(rank_bb[RANK_1]);
+        for(int attackIndex : pawnAttacks)
+        {
+            // generating a move with our pawn index and the index of whites attacked pawn/piece.
+            Move move = createMove(index, attackIndex);
+            moveList.push_back(move);
         }
     }
 }
 
-void nnchesslib::genNonSlidingMoves(ChessBoard board, MoveList& moveList, Color color, PieceType piece)
+void nnchesslib::genNonSlidingMoves(ChessBoard& board, MoveList& moveList, Color color, PieceType piece)
 {
     // getting target pieces on the board for a specific color.
     BitBoard targets = board.getBoard(color, piece);
+    BitBoard ourPieces = board.getBoard(color);
 
-    int count = __builtin_popcountll(targets.board);
-
-    for(int _ = 0; _ < count; _++)
+    for(int index : targets)
     {
-        int index = popLsb(targets.board);
-
-        if (index == -1)
-            continue;
+        BitBoard targetAttacks = BitBoard(Attacks::getNonSlidingAttacks(index, color, piece)) & ~ourPieces;
 
-        BitBoard targetMoves = Attacks::getNonSlidingAttacks(index, color, piece);
-        BitBoard targetAttacks = targetMoves.board & ~board.getBoard(color).board;
-
-        int attackCount = __builtin_popcountll(targetMoves.board);
-
-        if(targetAttacks.board)
+        for(int attackIndex : targetAttacks)
         {
-            for(int num = 0; num < attackCount; num++)
-            {
-                // getting the index of a square that our piece can move to/capture.
-                int attackIndex = popLsb(targetAttacks.board);
-
-                if (attackIndex == -1)
-                    continue;
-                // generating a move with our piece index and the potential square it can move to. 
-                Move move = createMove(index, attackIndex);       
-                moveList.push_back(move);
-            }
+            // generating a move with our piece index and the potential square it can move to. 
+            Move move = createMove(index, attackIndex);       
+            moveList.push_back(move);
         }
     }    
 }
 
-void nnchesslib::genSlidingMoves(ChessBoard board, MoveList& moveList, Color color, PieceType piece, BitBoard blockers)
+void nnchesslib::genSlidingMoves(ChessBoard& board, MoveList& moveList, Color color, PieceType piece, BitBoard blockers)
 {
     // getting target pieces on the board for a specific color.
     BitBoard targets = board.getBoard(color, piece);
+    BitBoard ourPieces = board.getBoard(color);
 
-    int count = __builtin_popcountll(targets.board);
-
-    for(int _ = 0; _ < count; _++)
+    for(int index : targets)
     {
-        int index = popLsb(targets.board);
+        BitBoard targetAttacks = BitBoard(Attacks::getSlidingAttacks(index, piece, blockers.board)) & ~ourPieces;
 
-        if (index == -1)
-            continue;
-
-        BitBoard targetMoves = Attacks::getSlidingAttacks(index, piece, blockers.board);
-        BitBoard targetAttacks = targetMoves.board & ~board.getBoard(color).board;
-
-        int attackCount = __builtin_popcountll(targetMoves.board);
-
-        if(targetAttacks.board)
+        for(int attackIndex : targetAttacks)
         {
-            for(int num = 0; num < attackCount; num++)
-            {
-                // getting the index of a square that our piece can move to/capture.
-                int attackIndex = popLsb(targetAttacks.board);
-
-                if (attackIndex == -1)
-                    continue;
-                
-                // generating a move with our piece index and the potential square it can move to. 
-                Move move = createMove(index, attackIndex);
-                moveList.push_back(move);
-            }
+            // generating a move with our piece index and the potential square it can move to. 
+            Move move = createMove(index, attackIndex);
+            moveList.push_back(move);
         }
     }
 }
 
 void nnchesslib::genPromotions(int pawnIndex, MoveList& moveList, Color color, BitBoard pawns)
 {
-    // counting the amount of attacked pawns.
-    int count = __builtin_popcountll(pawns.board);
-
-    for(int _ = 0; _ < count; _++)
+    for(int index : pawns)
     {
-        int index = popLsb(pawns.board);
-        
         Move queen = createMove(pawnIndex, index, QUEEN);
         Move knight = createMove(pawnIndex, index, KNIGHT);
         Move bishop = createMove(pawnIndex, index, BISHOP);
@@ -394,20 +505,21 @@ void nnchesslib::genPromotions(int pawnIndex, MoveList& moveList, Color color, B
     }
 }
 
-void nnchesslib::genCastlingMoves(ChessBoard board, MoveList& moveList, Color color, BitBoard blockers)
+void nnchesslib::genCastlingMoves(ChessBoard& board, MoveList& moveList, Color color, BitBoard blockers)
 {
+    // the castling rights and blockers are checked first, because checking for attacked squares is expensive.
     if(color == WHITE)
     {
         // white queenside:
-        bool attackedSquaresQS = board.squareAttacked(C1, color) || board.squareAttacked(D1, color) || board.squareAttacked(E1, color);
-        if(board.boardinfo.whiteCastleLong && !blockers.get(B1) && !blockers.get(C1) && !blockers.get(D1) && !attackedSquaresQS)
+        if(board.boardinfo.whiteCastleLong && !(blockers & BitBoard((1ULL << B1) | (1ULL << C1) | (1ULL << D1)))
+            && !board.squareAttacked(C1, color) && !board.squareAttacked(D1, color) && !board.squareAttacked(E1, color))
         {
             Move move = createMove(E1, C1, CASTLING);
             moveList.push_back(move);
         } 
         // white kingside:
-        bool attackedSquaresKS = board.squareAttacked(F1, color) || board.squareAttacked(G1, color) || board.squareAttacked(E1, color);
-        if(board.boardinfo.whiteCastleShort && !blockers.get(F1) && !blockers.get(G1) && !attackedSquaresKS)
+        if(board.boardinfo.whiteCastleShort && !(blockers & BitBoard((1ULL << F1) | (1ULL << G1)))
+            && !board.squareAttacked(F1, color) && !board.squareAttacked(G1, color) && !board.squareAttacked(E1, color))
         {
             Move move = createMove(E1, G1, CASTLING);
             moveList.push_back(move);
@@ -416,25 +528,18 @@ void nnchesslib::genCastlingMoves(ChessBoard board, MoveList& moveList, Color co
     if(color == BLACK)
     {
         // black queenside:
-        bool attackedSquaresQS = board.squareAttacked(C8, color) || board.squareAttacked(D8, color) || board.squareAttacked(E8, color);
-        if(board.boardinfo.blackCastleLong && !blockers.get(B8) && !blockers.get(C8) && !blockers.get(D8) && !attackedSquaresQS)
+        if(board.boardinfo.blackCastleLong && !(blockers & BitBoard((1ULL << B8) | (1ULL << C8) | (1ULL << D8)))
+            && !board.squareAttacked(C8, color) && !board.squareAttacked(D8, color) && !board.squareAttacked(E8, color))
         {
             Move move = createMove(E8, C8, CASTLING);
             moveList.push_back(move);
         } 
         // black kingside:
-        bool attackedSquaresKS = board.squareAttacked(F8, color) || board.squareAttacked(G8, color) || board.squareAttacked(E8, color);
-        if(board.boardinfo.blackCastleShort && !blockers.get(F8) && !blockers.get(G8) && !attackedSquaresKS)
+        if(board.boardinfo.blackCastleShort && !(blockers & BitBoard((1ULL << F8) | (1ULL << G8)))
+            && !board.squareAttacked(F8, color) && !board.squareAttacked(G8, color) && !board.squareAttacked(E8, color))
         {
             Move move = createMove(E8, G8, CASTLING);
             moveList.push_back(move);
         }
     }
-}
-
-int nnchesslib::popLsb(U64 &board)
-{
-    int lsbIndex = __builtin_ffsll(board) - 1;
-    board &= board - 1;
-    return lsbIndex;
 }
\ No newline at end of file
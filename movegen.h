@@ -3,38 +3,82 @@
 
 #include <board.h>
 #include <move.h>
-#include <vector>
+#include <cassert>
 
 namespace nnchesslib
 {
-    typedef std::vector<Move> MoveList;
+    // Fixed capacity list of moves, no position has more than 218 legal moves.
+    // Avoids the heap allocation a std::vector would do for every generated position.
+    class MoveList
+    {
+        public:
+            static const int MAX_MOVES = 256;
+
+            Move moves[MAX_MOVES];
+            int count = 0;
+
+            inline void push_back(Move move)
+            {
+                assert(count < MAX_MOVES);
+                moves[count++] = move;
+            }
+
+            inline int size() const { return count; }
+            inline bool empty() const { return count == 0; }
+            inline void clear() { count = 0; }
+
+            inline Move& operator[](int i) { return moves[i]; }
+            inline Move operator[](int i) const { return moves[i]; }
+
+            inline Move* begin() { return moves; }
+            inline Move* end() { return moves + count; }
+            inline const Move* begin() const { return moves; }
+            inline const Move* end() const { return moves + count; }
+    };
 
     // Function that generates pseudo-legal moves and looks at whether it put the king in check.
-    MoveList genLegalMoves(ChessBoard cboard);
+    // Every move is pushed and popped on the board, so it is left unchanged afterwards.
+    MoveList genLegalMoves(ChessBoard& cboard);
     // function for calling pseudo-legal move generating functions.
-    void genPseudoLegalMoves(ChessBoard cboard, MoveList& moveList);
+    void genPseudoLegalMoves(ChessBoard& cboard, MoveList& moveList);
+    // Generates only the pseudo-legal captures (en passant included) and promotions, for the quiescence search.
+    void genCaptureMoves(ChessBoard& cboard, MoveList& moveList);
+    // Generates the pseudo-legal moves that are neither captures nor promotions.
+    void genQuietMoves(ChessBoard& cboard, MoveList& moveList);
+    // Generates the legal moves out of check, the side to move has to be in check.
+    void genEvasions(ChessBoard& cboard, MoveList& moveList);
+    // Generates the legal moves that give check.
+    void genCheckingMoves(ChessBoard& cboard, MoveList& moveList);
+    // Checks whether a move, e.g. from the transposition table or a killer slot, is pseudo-legal in this position.
+    bool isPseudoLegal(ChessBoard& cboard, Move move);
 
-    void genWhiteMoves(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
-    void genBlackMoves(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
+    void genWhiteMoves(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
+    void genBlackMoves(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
 
     // pawns only move in one direction so seperate functions for white and black are needed.
-    void genWhiteSinglePawnMoves(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
-    void genWhiteDoublePawnMoves(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
-    void genWhitePawnCaptures(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
+    void genWhiteSinglePawnMoves(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
+    void genWhiteDoublePawnMoves(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
+    void genWhitePawnCaptures(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
 
-    void genBlackSinglePawnMoves(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
-    void genBlackDoublePawnMoves(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
-    void genBlackPawnCaptures(ChessBoard cboard, MoveList& moveList, BitBoard blockers);
+    void genBlackSinglePawnMoves(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
+    void genBlackDoublePawnMoves(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
+    void genBlackPawnCaptures(ChessBoard& cboard, MoveList& moveList, BitBoard blockers);
 
-    void genNonSlidingMoves(ChessBoard cboard, MoveList& moveList, Color color, PieceType piece);
-    void genSlidingMoves(ChessBoard cboard, MoveList& moveList, Color color, PieceType piece, BitBoard blockers);
-    void genKingMoves(ChessBoard cboard, MoveList& moveList, Color color, BitBoard blockers);
+    void genNonSlidingMoves(ChessBoard& cboard, MoveList& moveList, Color color, PieceType piece);
+    void genSlidingMoves(ChessBoard& cboard, MoveList& moveList, Color color, PieceType piece, BitBoard blockers);
+    void genKingMoves(ChessBoard& cboard, MoveList& moveList, Color color, BitBoard blockers);
 
     void genPromotions(int pawnIndex, MoveList& moveList, Color color, BitBoard pawns);
 
-    void genCastlingMoves(ChessBoard board, MoveList& moveList, Color color, BitBoard blockers);
+    void genCastlingMoves(ChessBoard& board, MoveList& moveList, Color color, BitBoard blockers);
 
-    int popLsb(U64 &board);
+    // Returns the index of the least significant bit and removes it from the board.
+    inline int popLsb(U64 &board)
+    {
+        int lsbIndex = __builtin_ffsll(board) - 1;
+        board &= board - 1;
+        return lsbIndex;
+    }
 }
 
 #endif
@@ -0,0 +1,176 @@
+// Movepick.cpp | Staged move ordering with history heuristics.
+
+#include <movepick.h>
+#include <movegen.h>
+#include <search.h>
+#include <board.h>
+#include <move.h>
+#include <cstring>
+
+using namespace nnchesslib;
+
+bool nnchesslib::isQuiet(ChessBoard& board, Move move)
+{
+    MoveType type = moveType(move);
+    return type != PROMOTION && type != ENPASSANT && board.getPieceTypeOnSquare(to_Square(move)) == TYPE_UD;
+}
+
+void SearchHistory::clear()
+{
+    std::memset(mainHistory, 0, sizeof(mainHistory));
+    std::memset(continuationHistory, 0, sizeof(continuationHistory));
+    std::memset(counterMoves, 0, sizeof(counterMoves));
+}
+
+MovePicker::MovePicker(ChessBoard& board, Move ttMove, const Move killers[2], Move counterMove,
+    const SearchHistory& history, const PieceToHistory* continuation[2])
+    : stage(TT_MOVE), board(board), history(history)
+{
+    this->continuation[0] = continuation[0];
+    this->continuation[1] = continuation[1];
+    us = board.getWhiteToMove() ? WHITE : BLACK;
+
+    // a table move can come from another position with the same index, so it is checked before it is handed out.
+    this->ttMove = isPseudoLegal(board, ttMove) ? ttMove : MOVE_NONE;
+
+    refutations[0] = killers[0];
+    refutations[1] = killers[1];
+    refutations[2] = counterMove;
+}
+
+Move MovePicker::nextMove()
+{
+    switch(stage)
+    {
+        case TT_MOVE:
+            stage = GEN_CAPTURES;
+            if(ttMove != MOVE_NONE) return ttMove;
+            [[fallthrough]];
+
+        case GEN_CAPTURES:
+        {
+            MoveList captures;
+            genCaptureMoves(board, captures);
+
+            end = 0;
+            for(Move move : captures)
+                moves[end++] = {move, Search::captureScore(board, move)};
+            current = 0;
+
+            stage = GOOD_CAPTURES;
+            [[fallthrough]];
+        }
+
+        case GOOD_CAPTURES:
+            while(current < end)
+            {
+                ExtMove move = pickBest();
+                if(move == ttMove) continue;
+
+                // the exchange is only calculated for the capture that is about to be searched.
+                if(Search::see(board, move) < 0)
+                {
+                    badCaptures[badCount++] = move;
+                    continue;
+                }
+                return move;
+            }
+            stage = REFUTATIONS;
+            [[fallthrough]];
+
+        case REFUTATIONS:
+            while(refutationIndex < 3 && !skipQuiets)
+            {
+                Move move = refutations[refutationIndex++];
+
+                // killers and counter moves come from other positions, so they might not even be possible here.
+                if(move == MOVE_NONE || move == ttMove) continue;
+                if(std::find(refutations, refutations + refutationIndex - 1, move) != refutations + refutationIndex - 1) continue;
+                if(!isPseudoLegal(board, move) || !isQuiet(board, move)) continue;
+
+                return move;
+            }
+            stage = GEN_QUIETS;
+            [[fallthrough]];
+
+        case GEN_QUIETS:
+        {
+            if(skipQuiets)
+            {
+                stage = BAD_CAPTURES;
+                return nextMove();
+            }
+
+            MoveList quiets;
+            genQuietMoves(board, quiets);
+
+            end = 0;
+            for(Move move : quiets)
+                moves[end++] = {move, 0};
+            scoreQuiets();
+            current = 0;
+
+            stage = QUIETS;
+            [[fallthrough]];
+        }
+
+        case QUIETS:
+            while(current < end && !skipQuiets)
+            {
+                ExtMove move = pickBest();
+                if(move == ttMove || isRefutation(move)) continue;
+                return move;
+            }
+            stage = BAD_CAPTURES;
+            [[fallthrough]];
+
+        case BAD_CAPTURES:
+            if(badIndex < badCount) return badCaptures[badIndex++];
+            stage = DONE;
+            [[fallthrough]];
+
+        case DONE:
+            return MOVE_NONE;
+    }
+
+    return MOVE_NONE;
+}
+
+void MovePicker::scoreQuiets()
+{
+    for(int i = 0; i < end; i++)
+    {
+        Move move = moves[i];
+        int from = from_Square(move);
+        int to = to_Square(move);
+        int piece = pieceIndex(us, board.getPieceTypeOnSquare(from));
+
+        int score = history.mainHistory[us][from][to];
+        for(int j = 0; j < 2; j++)
+        {
+            if(continuation[j])
+                score += (*continuation[j])[piece][to];
+        }
+
+        // the sum of three tables does not fit in the 16 bit score.
+        moves[i].score = score / 4;
+    }
+}
+
+ExtMove MovePicker::pickBest()
+{
+    // a full sort is wasted work when the first few moves already cause a cutoff.
+    int best = current;
+    for(int i = current + 1; i < end; i++)
+    {
+        if(moves[i].score > moves[best].score)
+            best = i;
+    }
+    std::swap(moves[current], moves[best]);
+    return moves[current++];
+}
+
+bool MovePicker::isRefutation(Move move)
+{
+    return move == refutations[0] || move == refutations[1] || move == refutations[2];
+}
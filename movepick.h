@@ -0,0 +1,99 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include <board.h>
+#include <move.h>
+#include <movegen.h>
+#include <types.h>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+namespace nnchesslib
+{
+    // History scores stay within [-HISTORY_MAX, HISTORY_MAX].
+    const int HISTORY_MAX = 16384;
+
+    // Scores indexed by the moving piece (color * 6 + piece type) and its target square.
+    typedef int16_t PieceToHistory[12][64];
+
+    // Adds a bonus (or a malus when negative) to a history entry. The further an entry already is from zero,
+    // the smaller the change, so entries never leave the bounds and old information slowly fades out (gravity).
+    inline void updateHistory(int16_t& entry, int bonus)
+    {
+        bonus = std::clamp(bonus, -HISTORY_MAX, HISTORY_MAX);
+        entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+    }
+
+    // Returns the history index of a piece, 0-5 are the black pieces and 6-11 the white pieces.
+    inline int pieceIndex(Color color, PieceType piece)
+    {
+        return color * 6 + piece;
+    }
+
+    // Returns true for moves that are neither captures nor promotions, only those are ordered by history.
+    bool isQuiet(ChessBoard& board, Move move);
+
+    // Move ordering statistics that one search thread learns from its beta cutoffs.
+    struct SearchHistory
+    {
+        // Butterfly history indexed by [color][from][to].
+        int16_t mainHistory[2][64][64];
+        // Indexed by the piece and target square of an earlier move, followed by those of the current move.
+        PieceToHistory continuationHistory[12][64];
+        // The quiet move that refuted the previous move last time, indexed by the piece and target square of that move.
+        Move counterMoves[12][64];
+
+        void clear();
+    };
+
+    // Hands out the moves of a position one by one, best first. Moves are only generated when the
+    // earlier stages did not cause a cutoff, so a cutoff by the transposition table move saves generating anything.
+    class MovePicker
+    {
+        public:
+            enum Stage
+            {
+                TT_MOVE, GEN_CAPTURES, GOOD_CAPTURES, REFUTATIONS, GEN_QUIETS, QUIETS, BAD_CAPTURES, DONE
+            };
+
+            // killers holds the two killer moves of this ply, continuation the history rows of the moves one and
+            // two plies ago (nullptr when there was no such move).
+            MovePicker(ChessBoard& board, Move ttMove, const Move killers[2], Move counterMove,
+                const SearchHistory& history, const PieceToHistory* continuation[2]);
+
+            // Returns the next pseudo-legal move, or MOVE_NONE when all moves have been picked.
+            Move nextMove();
+
+            Stage stage;
+            // Set by the search to skip the remaining quiet moves (late move pruning), captures are still returned.
+            bool skipQuiets = false;
+
+        private:
+            ChessBoard& board;
+            const SearchHistory& history;
+            const PieceToHistory* continuation[2];
+            Color us;
+
+            Move ttMove;
+            // killer 1, killer 2 and the counter move.
+            Move refutations[3];
+            int refutationIndex = 0;
+
+            ExtMove moves[256];
+            int current = 0;
+            int end = 0;
+
+            // captures that lose material are put aside and searched after the quiet moves.
+            ExtMove badCaptures[256];
+            int badCount = 0;
+            int badIndex = 0;
+
+            void scoreQuiets();
+            // Swaps the highest scoring remaining move to the current position and returns it.
+            ExtMove pickBest();
+            bool isRefutation(Move move);
+    };
+}
+
+#endif
\ No newline at end of file
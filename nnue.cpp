@@ -0,0 +1,408 @@
+// Nnue.cpp | Efficiently updatable neural network evaluation.
+
+#include <nnue.h>
+#include <board.h>
+#include <simd.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace nnchesslib;
+
+static std::shared_ptr<const NNUE::Network> currentNetwork;
+
+// The background verification of the last weight file given to loadActiveNetwork. Its thread is joined before the
+// next file is loaded and at exit, which is before currentNetwork is destroyed since it is declared after it.
+struct PendingNetwork
+{
+    std::mutex mutex;
+    std::thread verifier;
+    std::string path;
+    bool matched = true;
+
+    ~PendingNetwork()
+    {
+        if(verifier.joinable()) verifier.join();
+    }
+};
+
+static PendingNetwork pendingNetwork;
+
+static const char FILE_MAGIC[8] = {'N', 'N', 'C', 'L', 'N', 'N', 'U', 'E'};
+
+static constexpr size_t padded(size_t bytes)
+{
+    return (bytes + NNUE::ALIGNMENT - 1) / NNUE::ALIGNMENT * NNUE::ALIGNMENT;
+}
+
+// Sizes of the sections in bytes, in the order they are stored.
+static const size_t sectionSizes[] = {
+    sizeof(int16_t) * NNUE::FEATURES * NNUE::L1, sizeof(int16_t) * NNUE::L1,
+    sizeof(int8_t) * NNUE::L2 * 2 * NNUE::L1, sizeof(int32_t) * NNUE::L2,
+    sizeof(int8_t) * NNUE::L3 * NNUE::L2, sizeof(int32_t) * NNUE::L3,
+    sizeof(int8_t) * NNUE::L3, sizeof(int32_t)
+};
+
+static size_t payloadBytes()
+{
+    size_t bytes = 0;
+    for(size_t size : sectionSizes)
+        bytes += padded(size);
+    return bytes;
+}
+
+static constexpr size_t HEADER_SIZE = padded(sizeof(NNUE::FileHeader));
+
+// Multiplicative hash over 64 bit words, the payload size is always a multiple of ALIGNMENT.
+static U64 checksum(const uint8_t * data, size_t bytes)
+{
+    U64 hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < bytes; i += sizeof(U64))
+    {
+        U64 word;
+        std::memcpy(&word, data + i, sizeof(U64));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+static std::atomic<U64> nextNetworkId{1};
+
+NNUE::Network::Network() : id(nextNetworkId++)
+{
+    payloadSize = payloadBytes();
+    payload = (uint8_t *)::operator new(payloadSize, std::align_val_t(ALIGNMENT));
+    std::memset(payload, 0, payloadSize);
+    setSections();
+}
+
+NNUE::Network::Network(void * mapping, size_t mappingSize, size_t headerSize, U64 expectedChecksum)
+    : mapping(mapping), mappingSize(mappingSize), expectedChecksum(expectedChecksum), id(nextNetworkId++)
+{
+    payload = (uint8_t *)mapping + headerSize;
+    payloadSize = mappingSize - headerSize;
+    setSections();
+}
+
+NNUE::Network::~Network()
+{
+    if(mapping)
+        munmap(mapping, mappingSize);
+    else
+        ::operator delete(payload, std::align_val_t(ALIGNMENT));
+}
+
+void NNUE::Network::setSections()
+{
+    const uint8_t * sections[8];
+    size_t offset = 0;
+    for(int i = 0; i < 8; i++)
+    {
+        sections[i] = payload + offset;
+        offset += padded(sectionSizes[i]);
+    }
+
+    featureWeights = (const int16_t *)sections[0];
+    featureBiases = (const int16_t *)sections[1];
+    l1Weights = (const int8_t *)sections[2];
+    l1Biases = (const int32_t *)sections[3];
+    l2Weights = (const int8_t *)sections[4];
+    l2Biases = (const int32_t *)sections[5];
+    outputWeights = (const int8_t *)sections[6];
+    outputBias = (const int32_t *)sections[7];
+}
+
+void NNUE::Network::randomize(U64 seed)
+{
+    assert(!mapping);
+
+    // xorshift64*, the same generator as the zobrist keys.
+    auto next = [&seed]()
+    {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 2685821657736338717ULL;
+    };
+    auto small = [&next](int range) { return (int)(next() % (2 * range + 1)) - range; };
+
+    // the sections are only read-only for mapped networks, an owned payload can be written.
+    auto fill = [&small](const auto * section, size_t count, int range)
+    {
+        auto * values = const_cast<std::remove_const_t<std::remove_pointer_t<decltype(section)>> *>(section);
+        for(size_t i = 0; i < count; i++)
+            values[i] = small(range);
+    };
+
+    fill(featureWeights, (size_t)FEATURES * L1, 8);
+    fill(featureBiases, L1, 32);
+    fill(l1Weights, L2 * 2 * L1, 16);
+    fill(l1Biases, L2, 512);
+    fill(l2Weights, L3 * L2, 16);
+    fill(l2Biases, L3, 512);
+    fill(outputWeights, L3, 16);
+    fill(outputBias, 1, 256);
+}
+
+bool NNUE::Network::save(const std::string& path) const
+{
+    FileHeader header = {};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.headerSize = HEADER_SIZE;
+    header.features = FEATURES;
+    header.l1 = L1;
+    header.l2 = L2;
+    header.l3 = L3;
+    header.payloadSize = payloadSize;
+    header.checksum = checksum(payload, payloadSize);
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file) return false;
+
+    char headerBytes[HEADER_SIZE] = {};
+    std::memcpy(headerBytes, &header, sizeof(header));
+    file.write(headerBytes, HEADER_SIZE);
+    file.write((const char *)payload, payloadSize);
+    return (bool)file;
+}
+
+std::shared_ptr<NNUE::Network> NNUE::Network::load(const std::string& path, std::string * error)
+{
+    auto fail = [error](const std::string& message)
+    {
+        if(error) *error = message;
+        return std::shared_ptr<Network>();
+    };
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return fail("cannot open " + path);
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < HEADER_SIZE)
+    {
+        close(fd);
+        return fail(path + " is too small to be a weight file");
+    }
+
+    // a shared read-only mapping lets every process that loads the file use the same pages.
+    size_t size = info.st_size;
+    void * mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) return fail("cannot map " + path);
+
+    FileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+
+    std::string problem;
+    if(std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+        problem = path + " is not a weight file";
+    else if(header.version != FILE_VERSION)
+        problem = path + " has version " + std::to_string(header.version) + ", expected " + std::to_string(FILE_VERSION);
+    else if(header.features != FEATURES || header.l1 != L1 || header.l2 != L2 || header.l3 != L3)
+        problem = path + " has different layer sizes than this build";
+    else if(header.headerSize % ALIGNMENT != 0 || header.payloadSize != payloadBytes() || header.headerSize + header.payloadSize != size)
+        problem = path + " has an unexpected size";
+
+    if(!problem.empty())
+    {
+        munmap(mapping, size);
+        return fail(problem);
+    }
+
+    return std::shared_ptr<Network>(new Network(mapping, size, header.headerSize, header.checksum));
+}
+
+bool NNUE::Network::verify() const
+{
+    // owned networks have nothing to compare against.
+    if(!mapping) return true;
+
+    int state = checksumState.load(std::memory_order_acquire);
+    if(state == 0)
+    {
+        // threads that get here at the same time compute the same result, so there is no need to lock.
+        state = checksum(payload, payloadSize) == expectedChecksum ? 1 : 2;
+        checksumState.store(state, std::memory_order_release);
+    }
+    return state == 1;
+}
+
+bool NNUE::Network::isMapped() const
+{
+    return mapping != nullptr;
+}
+
+int NNUE::featureIndex(Color perspective, int kingSquare, Color color, PieceType piece, int square)
+{
+    if(perspective == BLACK)
+    {
+        kingSquare ^= 56;
+        square ^= 56;
+    }
+    int pieceIndex = piece * 2 + (color != perspective);
+    return (kingSquare * 10 + pieceIndex) * 64 + square;
+}
+
+static int kingSquareOf(const BoardInfo& info, Color color)
+{
+    BitBoard king = info.kings & (color == WHITE ? info.whitePieces : info.blackPieces);
+    return king.lsb();
+}
+
+static const int16_t * weightRow(const NNUE::Network& network, int feature)
+{
+    return &network.featureWeights[(size_t)feature * NNUE::L1];
+}
+
+void NNUE::refresh(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color perspective)
+{
+    int16_t * values = accumulator.values[perspective];
+    std::memcpy(values, network.featureBiases, sizeof(int16_t) * L1);
+
+    int kingSquare = kingSquareOf(info, perspective);
+    const Simd::Kernels& kernels = Simd::kernels();
+    const BitBoard pieceBoards[5] = {info.pawns, info.knights, info.bishops, info.rooks, info.queens};
+
+    for(int piece = PAWN; piece <= QUEEN; piece++)
+    {
+        for(int square : pieceBoards[piece] & info.whitePieces)
+            kernels.addRow(values, weightRow(network, featureIndex(perspective, kingSquare, WHITE, PieceType(piece), square)), L1);
+        for(int square : pieceBoards[piece] & info.blackPieces)
+            kernels.addRow(values, weightRow(network, featureIndex(perspective, kingSquare, BLACK, PieceType(piece), square)), L1);
+    }
+}
+
+void NNUE::refresh(const Network& network, const BoardInfo& info, Accumulator& accumulator)
+{
+    refresh(network, info, accumulator, WHITE);
+    refresh(network, info, accumulator, BLACK);
+}
+
+void NNUE::addPiece(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color color, PieceType piece, int square)
+{
+    if(piece == KING) return;
+
+    for(Color perspective : {WHITE, BLACK})
+    {
+        int feature = featureIndex(perspective, kingSquareOf(info, perspective), color, piece, square);
+        Simd::kernels().addRow(accumulator.values[perspective], weightRow(network, feature), L1);
+    }
+}
+
+void NNUE::removePiece(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color color, PieceType piece, int square)
+{
+    if(piece == KING) return;
+
+    for(Color perspective : {WHITE, BLACK})
+    {
+        int feature = featureIndex(perspective, kingSquareOf(info, perspective), color, piece, square);
+        Simd::kernels().subtractRow(accumulator.values[perspective], weightRow(network, feature), L1);
+    }
+}
+
+void NNUE::movePiece(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color color, PieceType piece, int from, int to)
+{
+    if(piece == KING) return;
+
+    for(Color perspective : {WHITE, BLACK})
+    {
+        int kingSquare = kingSquareOf(info, perspective);
+        const int16_t * added = weightRow(network, featureIndex(perspective, kingSquare, color, piece, to));
+        const int16_t * removed = weightRow(network, featureIndex(perspective, kingSquare, color, piece, from));
+        Simd::kernels().addSubtractRow(accumulator.values[perspective], added, removed, L1);
+    }
+}
+
+// int8 weights times 8 bit activations, summed in int32 and shifted back into the 0-127 activation range.
+static void denseLayer(const int8_t * weights, const int32_t * biases, const uint8_t * input, int inputs, uint8_t * output, int outputs)
+{
+    const Simd::Kernels& kernels = Simd::kernels();
+    for(int j = 0; j < outputs; j++)
+    {
+        int32_t sum = biases[j] + kernels.dot(input, weights + j * inputs, inputs);
+        output[j] = (uint8_t)std::clamp(sum >> NNUE::WEIGHT_SHIFT, 0, 127);
+    }
+}
+
+int NNUE::evaluate(const Network& network, const Accumulator& accumulator, Color sideToMove)
+{
+    // clipped relu on both accumulators, the side to move first.
+    alignas(64) uint8_t input[2 * L1];
+    const int16_t * us = accumulator.values[sideToMove];
+    const int16_t * them = accumulator.values[sideToMove == WHITE ? BLACK : WHITE];
+    Simd::kernels().clippedRelu(us, input, L1);
+    Simd::kernels().clippedRelu(them, input + L1, L1);
+
+    alignas(64) uint8_t hidden1[L2];
+    alignas(64) uint8_t hidden2[L3];
+    denseLayer(network.l1Weights, network.l1Biases, input, 2 * L1, hidden1, L2);
+    denseLayer(network.l2Weights, network.l2Biases, hidden1, L2, hidden2, L3);
+
+    int32_t output = *network.outputBias + Simd::kernels().dot(hidden2, network.outputWeights, L3);
+
+    return output / OUTPUT_SCALE;
+}
+
+int NNUE::evaluate(const ChessBoard& board)
+{
+    Color sideToMove = board.boardinfo.whiteToMove ? WHITE : BLACK;
+    return evaluate(*board.network, board.accumulators.back(), sideToMove);
+}
+
+std::shared_ptr<const NNUE::Network> NNUE::activeNetwork()
+{
+    return std::atomic_load(&currentNetwork);
+}
+
+void NNUE::setActiveNetwork(std::shared_ptr<const Network> network)
+{
+    std::atomic_store(&currentNetwork, network);
+}
+
+bool NNUE::loadActiveNetwork(const std::string& path, std::string * error)
+{
+    std::lock_guard<std::mutex> lock(pendingNetwork.mutex);
+    // networks become active in the order they were loaded, so the previous one is verified first.
+    if(pendingNetwork.verifier.joinable())
+        pendingNetwork.verifier.join();
+
+    std::shared_ptr<const Network> network = Network::load(path, error);
+    if(!network) return false;
+
+    pendingNetwork.path = path;
+    pendingNetwork.matched = false;
+    pendingNetwork.verifier = std::thread([network]()
+    {
+        // the checksum reads every weight, only a network that matches it is ever searched with.
+        if(!network->verify()) return;
+        setActiveNetwork(network);
+        pendingNetwork.matched = true;
+    });
+    return true;
+}
+
+bool NNUE::waitForNetwork(std::string * error)
+{
+    std::lock_guard<std::mutex> lock(pendingNetwork.mutex);
+    if(pendingNetwork.verifier.joinable())
+        pendingNetwork.verifier.join();
+
+    if(!pendingNetwork.matched)
+    {
+        if(error) *error = pendingNetwork.path + " does not match its checksum";
+        return false;
+    }
+    return true;
+}
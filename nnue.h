@@ -0,0 +1,144 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <types.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nnchesslib
+{
+    struct BoardInfo;
+    class ChessBoard;
+
+    namespace NNUE
+    {
+        // HalfKP: the features of a side are (own king square, piece, square) for every piece except the kings.
+        // 64 king squares * 10 pieces (5 types, 2 colors) * 64 squares.
+        const int FEATURES = 64 * 10 * 64;
+        // Size of the accumulator of each side, followed by two small dense layers and the output.
+        const int L1 = 256;
+        const int L2 = 32;
+        const int L3 = 32;
+
+        // The dense layers work with 8 bit activations between 0 and 127, and shift their int32 sums
+        // back into that range by WEIGHT_SHIFT. The output is divided by OUTPUT_SCALE to get centipawns.
+        const int WEIGHT_SHIFT = 6;
+        const int OUTPUT_SCALE = 16;
+
+        // Weight files start with a header, followed by the sections of the network in the order of the
+        // Network members, each padded to a multiple of ALIGNMENT bytes. All numbers are little endian.
+        const uint32_t FILE_VERSION = 1;
+        const size_t ALIGNMENT = 64;
+
+        struct FileHeader
+        {
+            char magic[8];
+            uint32_t version;
+            // Bytes before the first section, a multiple of ALIGNMENT.
+            uint32_t headerSize;
+            uint32_t features;
+            uint32_t l1;
+            uint32_t l2;
+            uint32_t l3;
+            // Bytes after the header, including the padding.
+            uint64_t payloadSize;
+            uint64_t checksum;
+        };
+
+        // Quantized weights of a network, either owned or mapped read-only from a weight file.
+        class Network
+        {
+            private:
+                uint8_t * payload = nullptr;
+                size_t payloadSize = 0;
+                // The whole file when the weights are mapped, nullptr when they are owned.
+                void * mapping = nullptr;
+                size_t mappingSize = 0;
+                U64 expectedChecksum = 0;
+                // 0 when the checksum has not been computed yet, 1 when it matched and 2 when it did not.
+                mutable std::atomic<int> checksumState{0};
+
+                // Points the sections into the payload.
+                void setSections();
+                // Takes over a mapped weight file whose header has been checked.
+                Network(void * mapping, size_t mappingSize, size_t headerSize, U64 expectedChecksum);
+            public:
+                // [FEATURES][L1], one row is added to the accumulator for every active feature.
+                const int16_t * featureWeights;
+                const int16_t * featureBiases;
+                // [L2][2 * L1], the accumulator of the side to move comes first.
+                const int8_t * l1Weights;
+                const int32_t * l1Biases;
+                // [L3][L2]
+                const int8_t * l2Weights;
+                const int32_t * l2Biases;
+                const int8_t * outputWeights;
+                const int32_t * outputBias;
+                // Unique for every network created by this process, starting at 1. Unlike the address it is never
+                // reused, so it can tell networks apart in tables that outlive them.
+                const U64 id;
+
+                // Allocates a network with all weights zero.
+                Network();
+                ~Network();
+                Network(const Network&) = delete;
+                Network& operator=(const Network&) = delete;
+
+                // Fills an owned network with small pseudo-random weights, for testing without a trained network.
+                void randomize(U64 seed);
+
+                // Writes the network to a weight file, returns false when the file cannot be written.
+                bool save(const std::string& path) const;
+                // Maps a weight file into memory, so processes using the same file share it in the page cache.
+                // Only the header is checked, the weights are read when they are used. Returns nullptr and sets
+                // the error (when given) if the file cannot be used.
+                static std::shared_ptr<Network> load(const std::string& path, std::string * error = nullptr);
+
+                // Returns true if the weights match the checksum of the file. It is computed on the first call only.
+                bool verify() const;
+                // Returns true if the weights are mapped from a file.
+                bool isMapped() const;
+        };
+
+        // Sums of the feature weight rows of all active features plus the biases, for both sides (indexed by Color).
+        struct alignas(64) Accumulator
+        {
+            int16_t values[2][L1];
+        };
+
+        // Returns the index of a feature from the perspective of one side. Black looks at a vertically flipped
+        // board, so both sides use the same weights and the position looks the same from either side.
+        int featureIndex(Color perspective, int kingSquare, Color color, PieceType piece, int square);
+
+        // Computes the accumulator of one side from scratch.
+        void refresh(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color perspective);
+        void refresh(const Network& network, const BoardInfo& info, Accumulator& accumulator);
+
+        // Adds or removes a piece in the accumulator of both sides. Kings are not features, their moves need a refresh.
+        void addPiece(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color color, PieceType piece, int square);
+        void removePiece(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color color, PieceType piece, int square);
+        void movePiece(const Network& network, const BoardInfo& info, Accumulator& accumulator, Color color, PieceType piece, int from, int to);
+
+        // Runs the dense layers on an accumulator, returns centipawns from the side to move.
+        int evaluate(const Network& network, const Accumulator& accumulator, Color sideToMove);
+        // Evaluates a board that has a network set.
+        int evaluate(const ChessBoard& board);
+
+        // The network new searches evaluate with, nullptr means the handcrafted evaluation is used.
+        std::shared_ptr<const Network> activeNetwork();
+        void setActiveNetwork(std::shared_ptr<const Network> network);
+        // Loads a weight file and makes it the active network once its checksum matches. The checksum reads every
+        // weight, so it is computed by a background thread and the previous network stays active until then.
+        // Searches that are running keep the network they started with, so a new network can be swapped in at
+        // any time. Returns false and sets the error (when given) if the file cannot be used at all.
+        bool loadActiveNetwork(const std::string& path, std::string * error = nullptr);
+        // Waits for the verification of the last loaded weight file. Returns false and sets the error (when given)
+        // if it did not match its checksum, the active network was then left unchanged.
+        bool waitForNetwork(std::string * error = nullptr);
+    }
+}
+
+#endif
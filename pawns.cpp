@@ -0,0 +1,146 @@
+// Pawns.cpp | Pawn structure evaluation and its cache.
+
+#include <pawns.h>
+#include <board.h>
+
+using namespace nnchesslib;
+
+// Penalties and bonuses for the middlegame and endgame.
+static const int DOUBLED_MG = -10, DOUBLED_EG = -20;
+static const int ISOLATED_MG = -5, ISOLATED_EG = -15;
+static const int BACKWARD_MG = -8, BACKWARD_EG = -10;
+// Indexed by the rank of the pawn from its own side.
+static const int passedMg[8] = {0, 5, 10, 15, 30, 50, 80, 0};
+static const int passedEg[8] = {0, 10, 20, 35, 60, 100, 150, 0};
+
+static U64 fillUp(U64 bits)
+{
+    bits |= bits << 8;
+    bits |= bits << 16;
+    return bits | bits << 32;
+}
+
+static U64 fillDown(U64 bits)
+{
+    bits |= bits >> 8;
+    bits |= bits >> 16;
+    return bits | bits >> 32;
+}
+
+static U64 attacksOf(U64 pawns, Color color)
+{
+    if(color == WHITE) return ((pawns & ~file_bb[FILE_A]) << 7) | ((pawns & ~file_bb[FILE_H]) << 9);
+    return ((pawns & ~file_bb[FILE_A]) >> 9) | ((pawns & ~file_bb[FILE_H]) >> 7);
+}
+
+static U64 adjacentFiles(int file)
+{
+    return (file > FILE_A ? file_bb[file - 1] : 0) | (file < FILE_H ? file_bb[file + 1] : 0);
+}
+
+PawnTable::PawnTable()
+{
+    clear();
+}
+
+void PawnTable::clear()
+{
+    // no pawn structure has this key, an empty board has key 0.
+    for(PawnEntry &entry : entries)
+        entry.key = ~(U64)0;
+    SEARCH_STAT(probes.set(0));
+    SEARCH_STAT(hits.set(0));
+}
+
+#ifdef SEARCH_STATS
+double PawnTable::hitRate() const
+{
+    return probes.get() ? (double)hits.get() / probes.get() : 0;
+}
+#endif
+
+const PawnEntry& PawnTable::probe(const BoardInfo& info)
+{
+    PawnEntry& entry = entries[info.pawnKey & (ENTRIES - 1)];
+    SEARCH_STAT(probes.add());
+
+    if(entry.key == info.pawnKey)
+    {
+        SEARCH_STAT(hits.add());
+        return entry;
+    }
+
+    evaluate(info, entry);
+    return entry;
+}
+
+void PawnTable::evaluate(const BoardInfo& info, PawnEntry& entry)
+{
+    entry.key = info.pawnKey;
+    int mg = 0, eg = 0;
+
+    for(Color us : {WHITE, BLACK})
+    {
+        Color them = us == WHITE ? BLACK : WHITE;
+        U64 ours = (info.pawns & (us == WHITE ? info.whitePieces : info.blackPieces)).board;
+        U64 theirs = (info.pawns & (them == WHITE ? info.whitePieces : info.blackPieces)).board;
+        U64 theirAttacks = attacksOf(theirs, them);
+
+        entry.pawnAttacks[us] = attacksOf(ours, us);
+        entry.attackSpans[us] = attacksOf(us == WHITE ? fillUp(ours) : fillDown(ours), us);
+        entry.passedPawns[us] = 0;
+        entry.semiOpenFiles[us] = 0;
+
+        int usMg = 0, usEg = 0;
+        for(int square : BitBoard(ours))
+        {
+            int file = square % 8;
+            int rank = us == WHITE ? square / 8 : 7 - square / 8;
+            U64 bit = (U64)1 << square;
+            // front holds the squares ahead of the pawn on its file, frontSpan adds those on the files next to it.
+            U64 front = us == WHITE ? fillUp(bit << 8) : fillDown(bit >> 8);
+            U64 frontSpan = front | (us == WHITE ? fillUp(attacksOf(bit, us)) : fillDown(attacksOf(bit, us)));
+            U64 neighbours = ours & adjacentFiles(file);
+
+            if(front & ours)
+            {
+                usMg += DOUBLED_MG;
+                usEg += DOUBLED_EG;
+            }
+
+            if(!neighbours)
+            {
+                usMg += ISOLATED_MG;
+                usEg += ISOLATED_EG;
+            }
+            else
+            {
+                // backward: no neighbour is level with it or behind it, and its stop square is attacked.
+                U64 levelOrBehind = us == WHITE ? ~(U64)0 >> (8 * (7 - square / 8)) : ~(U64)0 << (8 * (square / 8));
+                U64 stop = us == WHITE ? bit << 8 : bit >> 8;
+                if(!(neighbours & levelOrBehind) && (stop & theirAttacks))
+                {
+                    usMg += BACKWARD_MG;
+                    usEg += BACKWARD_EG;
+                }
+            }
+
+            if(!(frontSpan & theirs))
+            {
+                entry.passedPawns[us] |= bit;
+                usMg += passedMg[rank];
+                usEg += passedEg[rank];
+            }
+        }
+
+        for(int file = FILE_A; file <= FILE_H; file++)
+            if(!(ours & file_bb[file]))
+                entry.semiOpenFiles[us] |= 1 << file;
+
+        mg += us == WHITE ? usMg : -usMg;
+        eg += us == WHITE ? usEg : -usEg;
+    }
+
+    entry.mgScore = mg;
+    entry.egScore = eg;
+}
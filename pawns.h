@@ -0,0 +1,61 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include <types.h>
+#include <stats.h>
+#include <cstdint>
+
+namespace nnchesslib
+{
+    struct BoardInfo;
+
+    // Pawn structure evaluation and the bitboards derived from it, both indexed by Color where there are two.
+    // The 64 bit members come first so the entry fills exactly one cache line without padding between them.
+    struct alignas(64) PawnEntry
+    {
+        U64 key;
+        U64 passedPawns[2];
+        U64 pawnAttacks[2];
+        // Squares the pawns attack now or could attack after advancing.
+        U64 attackSpans[2];
+        // From white's view, for the middlegame and endgame.
+        int16_t mgScore;
+        int16_t egScore;
+        // One bit per file without pawns of that color.
+        uint8_t semiOpenFiles[2];
+
+        // Files without any pawns.
+        inline uint8_t openFiles() const { return semiOpenFiles[WHITE] & semiOpenFiles[BLACK]; }
+    };
+
+    static_assert(sizeof(PawnEntry) == 64, "a pawn entry should fill one cache line");
+
+    // Cache of pawn structure evaluations indexed by the pawn key. Every search thread has its own,
+    // pawn structures change rarely so most probes are hits.
+    class PawnTable
+    {
+        public:
+            static const int ENTRIES = 16384;
+
+#ifdef SEARCH_STATS
+            StatCounter probes;
+            StatCounter hits;
+
+            double hitRate() const;
+#endif
+
+            PawnTable();
+
+            // Returns the entry of a pawn structure, evaluating it first when it is not in the table.
+            const PawnEntry& probe(const BoardInfo& info);
+            void clear();
+
+            // Evaluates the pawn structure of a position from scratch.
+            static void evaluate(const BoardInfo& info, PawnEntry& entry);
+
+        private:
+            PawnEntry entries[ENTRIES];
+    };
+}
+
+#endif
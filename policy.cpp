@@ -0,0 +1,64 @@
+// Policy.cpp | Mapping between moves and the outputs of policy networks.
+
+#include <policy.h>
+#include <board.h>
+#include <movegen.h>
+#include <simd.h>
+#include <cassert>
+#include <cstring>
+
+using namespace nnchesslib;
+
+Move Policy::indexToMove(ChessBoard& board, PolicyMap map, int index)
+{
+    Color us = board.boardinfo.whiteToMove ? WHITE : BLACK;
+    Move move = indexToMove(map, index, us);
+    if(moveType(move) == PROMOTION) return move;
+
+    int from = from_Square(move);
+    int to = to_Square(move);
+    PieceType piece = board.getPieceTypeOnSquare(from);
+
+    if(piece == KING && (to - from == 2 || from - to == 2))
+        return createMove(from, to, CASTLING);
+
+    if(piece == PAWN)
+    {
+        if(to / 8 == 0 || to / 8 == 7)
+            return createMove(from, to, QUEEN);
+        // a diagonal pawn move to an empty square can only be en passant.
+        if(from % 8 != to % 8 && board.getPieceTypeOnSquare(to) == TYPE_UD)
+            return createMove(from, to, ENPASSANT);
+    }
+    return move;
+}
+
+void Policy::writeMask(const MoveList& moves, Color sideToMove, PolicyMap map, U64 * mask)
+{
+    int words = (policySize(map) + 63) / 64;
+    std::memset(mask, 0, words * sizeof(U64));
+
+    for(Move move : moves)
+    {
+        int index = moveToIndex(map, move, sideToMove);
+        // every legal move has an index, other moves are left out of the mask in release builds.
+        assert(index >= 0);
+        if(index < 0) continue;
+        mask[index / 64] |= (U64)1 << (index % 64);
+    }
+}
+
+void Policy::writeMask(const MoveList& moves, Color sideToMove, PolicyMap map, float * mask)
+{
+    U64 bits[(ALPHAZERO_SIZE + 63) / 64];
+    writeMask(moves, sideToMove, map, bits);
+
+    // whole words are expanded 64 values at a time, the last partial word one value at a time.
+    const Simd::Kernels& kernels = Simd::kernels();
+    int size = policySize(map);
+    int full = size / 64;
+    for(int word = 0; word < full; word++)
+        kernels.expandBitsFloat(bits[word], mask + word * 64);
+    for(int i = full * 64; i < size; i++)
+        mask[i] = bits[i / 64] >> (i % 64) & 1;
+}
@@ -0,0 +1,141 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <move.h>
+#include <types.h>
+#include <cstdint>
+
+namespace nnchesslib
+{
+    class ChessBoard;
+    class MoveList;
+
+    namespace Policy
+    {
+        // Action spaces of policy heads. Both describe moves from the side to move's view, so black's moves are
+        // flipped to white's side of the board first. Queen promotions share the index of the plain pawn move.
+        // ALPHAZERO: from square * 73 + plane, planes 0-55 are 7 distances in 8 queen directions (N, NE, E, SE,
+        // S, SW, W, NW), 56-63 the knight jumps and 64-72 the underpromotions (left, straight, right times N, B, R).
+        // LIST_1858: every queen or knight move between two squares, ordered by from and to square, followed by
+        // the 66 underpromotions. The same size as the list of lc0, but not its order.
+        enum PolicyMap
+        {
+            ALPHAZERO, LIST_1858
+        };
+
+        const int ALPHAZERO_SIZE = 73 * 64;
+        const int LIST_1858_SIZE = 1858;
+
+        // 0 for moves without underpromotion, 1-3 for promotions to a knight, bishop and rook.
+        constexpr int underpromotion(Move move)
+        {
+            return moveType(move) == PROMOTION && movePromotionType(move) != QUEEN ? movePromotionType(move) : 0;
+        }
+
+        // Returns the alphazero plane of a move for white, -1 if the squares are not a queen or knight move apart.
+        constexpr int alphaZeroPlane(int from, int to, int promotion)
+        {
+            int dx = to % 8 - from % 8;
+            int dy = to / 8 - from / 8;
+
+            if(promotion)
+            {
+                if(from / 8 != 6 || dy != 1 || dx < -1 || dx > 1) return -1;
+                return 64 + (dx + 1) * 3 + (promotion - 1);
+            }
+
+            const int knightJumps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+            for(int jump = 0; jump < 8; jump++)
+                if(dx == knightJumps[jump][0] && dy == knightJumps[jump][1]) return 56 + jump;
+
+            int distance = dx != 0 ? (dx < 0 ? -dx : dx) : (dy < 0 ? -dy : dy);
+            if(distance == 0 || (dx != 0 && dy != 0 && dx != dy && dx != -dy)) return -1;
+
+            const int directions[8][2] = {{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+            for(int direction = 0; direction < 8; direction++)
+                if(dx == directions[direction][0] * distance && dy == directions[direction][1] * distance)
+                    return direction * 7 + distance - 1;
+            return -1;
+        }
+
+        // Lookup tables in both directions, moves are stored with only the from, to and underpromotion.
+        template<int Size>
+        struct PolicyTable
+        {
+            // [underpromotion][from][to], -1 when the move is not in the action space.
+            int16_t index[4][64][64];
+            Move moves[Size];
+
+            constexpr PolicyTable() : index{}, moves{} {}
+        };
+
+        constexpr Move tableMove(int from, int to, int promotion)
+        {
+            return promotion ? createMove(from, to, PieceType(promotion)) : createMove(from, to);
+        }
+
+        constexpr PolicyTable<ALPHAZERO_SIZE> buildAlphaZeroTable()
+        {
+            PolicyTable<ALPHAZERO_SIZE> table;
+            for(int promotion = 0; promotion < 4; promotion++)
+                for(int from = 0; from < 64; from++)
+                    for(int to = 0; to < 64; to++)
+                    {
+                        int plane = alphaZeroPlane(from, to, promotion);
+                        table.index[promotion][from][to] = plane < 0 ? -1 : from * 73 + plane;
+                        if(plane >= 0) table.moves[from * 73 + plane] = tableMove(from, to, promotion);
+                    }
+            return table;
+        }
+
+        constexpr PolicyTable<LIST_1858_SIZE> buildList1858Table()
+        {
+            PolicyTable<LIST_1858_SIZE> table;
+            int count = 0;
+            for(int promotion = 0; promotion < 4; promotion++)
+                for(int from = 0; from < 64; from++)
+                    for(int to = 0; to < 64; to++)
+                    {
+                        bool inList = alphaZeroPlane(from, to, promotion) >= 0;
+                        table.index[promotion][from][to] = inList ? count : -1;
+                        if(inList) table.moves[count++] = tableMove(from, to, promotion);
+                    }
+            return table;
+        }
+
+        inline constexpr PolicyTable<ALPHAZERO_SIZE> alphaZeroTable = buildAlphaZeroTable();
+        inline constexpr PolicyTable<LIST_1858_SIZE> list1858Table = buildList1858Table();
+
+        constexpr int policySize(PolicyMap map)
+        {
+            return map == ALPHAZERO ? ALPHAZERO_SIZE : LIST_1858_SIZE;
+        }
+
+        // Returns the policy index of a move of the side to move, -1 for moves outside the action space (none are legal).
+        constexpr int moveToIndex(PolicyMap map, Move move, Color sideToMove)
+        {
+            if(sideToMove == BLACK) move = flipMove(move);
+            int from = from_Square(move), to = to_Square(move), promotion = underpromotion(move);
+            return map == ALPHAZERO ? alphaZeroTable.index[promotion][from][to] : list1858Table.index[promotion][from][to];
+        }
+
+        // Returns the move of a policy index for the side to move. Only underpromotions are flagged, castling,
+        // en passant and queen promotions look like plain moves, see the board version for flagged moves.
+        constexpr Move indexToMove(PolicyMap map, int index, Color sideToMove)
+        {
+            Move move = map == ALPHAZERO ? alphaZeroTable.moves[index] : list1858Table.moves[index];
+            return sideToMove == BLACK ? flipMove(move) : move;
+        }
+
+        // Returns the move of a policy index in a position with the flags of its type, the move is not checked for legality.
+        Move indexToMove(ChessBoard& board, PolicyMap map, int index);
+
+        // Sets the bits of the moves in a bitmask of (policySize + 63) / 64 words and clears the others. The moves
+        // should be legal, moves outside the action space are skipped.
+        void writeMask(const MoveList& moves, Color sideToMove, PolicyMap map, U64 * mask);
+        // Writes 1.0f for the moves and 0.0f for the rest of the policySize values.
+        void writeMask(const MoveList& moves, Color sideToMove, PolicyMap map, float * mask);
+    }
+}
+
+#endif
@@ -0,0 +1,96 @@
+// Ponder.cpp | Background searches and pondering.
+
+#include <ponder.h>
+#include <search.h>
+#include <board.h>
+
+using namespace nnchesslib;
+
+CancellationToken::CancellationToken(std::shared_ptr<Search::SharedState> state) : state(state)
+{
+}
+
+void CancellationToken::cancel()
+{
+    if(state) state->stop.store(true);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return state && state->stop.load();
+}
+
+AsyncSearch::~AsyncSearch()
+{
+    stop();
+    if(thread.joinable()) thread.join();
+}
+
+void AsyncSearch::start(const ChessBoard& board, SearchLimits limits)
+{
+    stop();
+    if(thread.joinable()) thread.join();
+
+    // every search gets a new state, so a token of an earlier search cannot stop this one.
+    state = std::make_shared<Search::SharedState>();
+    std::shared_ptr<Search::SharedState> searchState = state;
+
+    thread = std::thread([this, board, limits, searchState]() { result = Search::search(board, limits, *searchState); });
+}
+
+void AsyncSearch::startPondering(const ChessBoard& board, Move ourMove, Move expectedReply, SearchLimits limits)
+{
+    stop();
+    if(thread.joinable()) thread.join();
+
+    ChessBoard ponderBoard = board;
+    ponderBoard.pushMove(ourMove);
+    ponderBoard.pushMove(expectedReply);
+
+    state = std::make_shared<Search::SharedState>();
+    state->pondering.store(true);
+    std::shared_ptr<Search::SharedState> searchState = state;
+
+    thread = std::thread([this, ponderBoard, limits, searchState]() { result = Search::search(ponderBoard, limits, *searchState); });
+}
+
+void AsyncSearch::ponderHit()
+{
+    if(state) state->pondering.store(false);
+}
+
+void AsyncSearch::ponderMiss(const ChessBoard& board, SearchLimits limits)
+{
+    // the work is not completely lost, the positions searched so far are still in the transposition table.
+    start(board, limits);
+}
+
+void AsyncSearch::stop()
+{
+    if(state)
+    {
+        state->pondering.store(false);
+        state->stop.store(true);
+    }
+}
+
+SearchResult AsyncSearch::wait()
+{
+    if(thread.joinable()) thread.join();
+    return result;
+}
+
+bool AsyncSearch::isSearching() const
+{
+    return thread.joinable() && state && !state->stop.load();
+}
+
+bool AsyncSearch::isPondering() const
+{
+    return isSearching() && state->pondering.load();
+}
+
+CancellationToken AsyncSearch::token() const
+{
+    return CancellationToken(state);
+}
@@ -0,0 +1,66 @@
+#ifndef PONDER_H
+#define PONDER_H
+
+#include <search.h>
+#include <board.h>
+#include <move.h>
+#include <memory>
+#include <thread>
+
+namespace nnchesslib
+{
+    // Stops a running search from any thread, copies all refer to the same search.
+    class CancellationToken
+    {
+        public:
+            CancellationToken() = default;
+            explicit CancellationToken(std::shared_ptr<Search::SharedState> state);
+
+            void cancel();
+            bool isCancelled() const;
+
+        private:
+            std::shared_ptr<Search::SharedState> state;
+    };
+
+    // Runs a search on a background thread, so the caller can keep handling input. It is also used for
+    // pondering: searching the expected position while the opponent thinks, and then either converting it into
+    // the real search (ponderhit) or throwing it away (miss). The transposition table is kept in both cases.
+    class AsyncSearch
+    {
+        public:
+            AsyncSearch() = default;
+            AsyncSearch(const AsyncSearch&) = delete;
+            AsyncSearch& operator=(const AsyncSearch&) = delete;
+            // Cancels a search that is still running.
+            ~AsyncSearch();
+
+            // Starts searching a position. A search that is still running is cancelled first.
+            void start(const ChessBoard& board, SearchLimits limits);
+            // Starts pondering on the position after our move and the reply we expect from the opponent.
+            // The limits apply from the start of pondering once ponderHit() is called.
+            void startPondering(const ChessBoard& board, Move ourMove, Move expectedReply, SearchLimits limits);
+
+            // The opponent played the expected move: the ponder search becomes the real search. The time spent
+            // pondering counts as search time, so a long ponder can make the search finish right away.
+            void ponderHit();
+            // The opponent played another move: the ponder search is cancelled and the given position is searched instead.
+            void ponderMiss(const ChessBoard& board, SearchLimits limits);
+
+            // Cancels the running search, wait() still returns the best move found so far.
+            void stop();
+            // Waits for the search to finish and returns its result.
+            SearchResult wait();
+
+            bool isSearching() const;
+            bool isPondering() const;
+            CancellationToken token() const;
+
+        private:
+            std::shared_ptr<Search::SharedState> state;
+            std::thread thread;
+            SearchResult result;
+    };
+}
+
+#endif
@@ -0,0 +1,845 @@
+// Search.cpp | Iterative deepening negamax alpha-beta search.
+
+#include <search.h>
+#include <evaluate.h>
+#include <evalcache.h>
+#include <movegen.h>
+#include <board.h>
+#include <move.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <cmath>
+#include <iostream>
+
+using namespace nnchesslib;
+
+int Search::reductions[MAX_PLY][64];
+
+// the evaluation cache gets a default size in init or on the first search, unless a size (possibly 0) was set before.
+static bool evalCacheSizeSet = false;
+
+// allocates the tables that have not been given a size yet.
+static void allocateTables()
+{
+    if(TT.empty())
+        Search::setHashSize(16);
+    if(!evalCacheSizeSet)
+        Search::setEvalCacheSize(4);
+}
+
+// workers of finished searches, taken again by the next search. searches running at the same time each take
+// their own workers, a search that finds the pool empty allocates new ones.
+static std::mutex workerPoolMutex;
+static std::vector<std::unique_ptr<Search::SearchWorker>> workerPool;
+
+Search::SearchWorker::SearchWorker(const ChessBoard& board, SearchLimits limits, SharedState * shared, int threadId)
+{
+    reset(board, limits, shared, threadId);
+}
+
+void Search::SearchWorker::reset(const ChessBoard& board, SearchLimits limits, SharedState * shared, int threadId)
+{
+    this->board = board;
+    this->limits = limits;
+    this->shared = shared;
+    this->threadId = threadId;
+
+    // a board that already has a network keeps it, otherwise the active network is used when there is one.
+    network.reset();
+    if(!this->board.network && (network = NNUE::activeNetwork()))
+        this->board.setNetwork(network.get());
+
+    nodes = 0;
+    reportedNodes = 0;
+    SEARCH_STAT(stats.reset());
+    SEARCH_STAT(pawnTable.probes.set(0));
+    SEARCH_STAT(pawnTable.hits.set(0));
+    stopped = false;
+    nullMoveMinPly = 0;
+    rootDepth = 0;
+    completedDepth = 0;
+    pvLineMoves.clear();
+
+    history.clear();
+    this->board.pawnTable = &pawnTable;
+    std::fill(&killers[0][0], &killers[0][0] + MAX_PLY * 2, MOVE_NONE);
+    std::fill(currentMove, currentMove + MAX_PLY, MOVE_NONE);
+    std::fill(excludedMoves, excludedMoves + MAX_PLY, MOVE_NONE);
+}
+
+SearchResult Search::SearchWorker::iterate()
+{
+    SearchResult result;
+    // the number of iterations in a row that ended with the same best move.
+    int stableIterations = 0;
+
+    // odd helper threads search one ply deeper than the main thread, so the threads do not all
+    // search the same tree in lockstep but fill the table with results the others can use.
+    int depthOffset = threadId % 2;
+
+    for(int iteration = 1; iteration <= limits.depth && iteration < MAX_PLY; iteration++)
+    {
+        int depth = std::min(iteration + depthOffset, std::min(limits.depth, MAX_PLY - 1));
+        rootDepth = depth;
+        SEARCH_STAT(U64 iterationStartNodes = nodes);
+
+        // every next line is searched without the root moves of the lines before it. it cannot be better than
+        // the line before it, so it is searched with a window below that score and only re-searched when it is not.
+        std::vector<PVLine> lines;
+        pvLineMoves.clear();
+        for(int pvIndex = 0; pvIndex < std::max(1, limits.multiPV); pvIndex++)
+        {
+            int beta = pvIndex == 0 ? VALUE_INFINITE : lines.back().score + 1;
+            int score = negamax(-VALUE_INFINITE, beta, depth, 0);
+            if(!stopped && score >= beta)
+                score = negamax(-VALUE_INFINITE, VALUE_INFINITE, depth, 0);
+
+            if(stopped) break;
+
+            // no line is left when there are fewer legal moves than lines. without any legal move
+            // there is still the score of the position (mate or stalemate), with an empty line.
+            if(pvLength[0] == 0)
+            {
+                if(pvIndex == 0) lines.push_back({score, {}});
+                break;
+            }
+
+            lines.push_back({score, std::vector<Move>(pvTable[0], pvTable[0] + pvLength[0])});
+            pvLineMoves.push_back(pvTable[0][0]);
+        }
+
+        // an unfinished iteration cannot be trusted, the previous one is used instead.
+        if(stopped) break;
+
+        // a line that failed high against the line before it was found better after all.
+        std::stable_sort(lines.begin(), lines.end(), [](const PVLine& a, const PVLine& b) { return a.score > b.score; });
+
+        int score = lines[0].score;
+        result.score = score;
+        result.depth = depth;
+        result.pv = lines[0].pv;
+        result.lines = lines;
+        Move previousBestMove = result.bestMove;
+        result.bestMove = result.pv.empty() ? MOVE_NONE : result.pv[0];
+        completedDepth = depth;
+
+        SEARCH_STAT(stats.previousIterationNodes.set(stats.lastIterationNodes.get()));
+        SEARCH_STAT(stats.lastIterationNodes.set(nodes - iterationStartNodes));
+
+        if(threadId == 0 && limits.onIteration)
+        {
+            result.nodes = nodes;
+            SEARCH_STAT(result.stats = shared->collectStats());
+            limits.onIteration(result);
+        }
+
+        // searching deeper will not find a faster mate than one that is already proven.
+        // with several lines the other lines may still change, so they are searched on.
+        if(limits.multiPV <= 1 && isMateScore(score) && VALUE_MATE - std::abs(score) <= depth) break;
+        if(depth >= limits.depth) break;
+
+        // the main thread decides when the search has used enough of its time. a best move that stayed the same
+        // for several iterations is unlikely to change, so less time is spent on it than on one that keeps changing.
+        if(threadId == 0 && shared->time.enabled && !shared->pondering.load(std::memory_order_relaxed))
+        {
+            stableIterations = result.bestMove == previousBestMove ? stableIterations + 1 : 0;
+            double scale = 1.5 - 0.15 * std::min(stableIterations, 6);
+
+            if(shared->time.elapsed() >= shared->time.optimumTime * scale) break;
+        }
+    }
+
+    // a ponder search has to keep going until it is known whether the opponent played the expected move.
+    while(threadId == 0 && shared->pondering.load() && !shared->stop.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // when even the first iteration was stopped, any legal move is better than no move.
+    if(result.bestMove == MOVE_NONE)
+    {
+        MoveList moves = genLegalMoves(board);
+        if(!moves.empty())
+        {
+            result.bestMove = moves[0];
+            result.pv = {moves[0]};
+            result.lines = {{0, result.pv}};
+        }
+    }
+
+    result.nodes = nodes;
+
+    return result;
+}
+
+int Search::SearchWorker::negamax(int alpha, int beta, int depth, int ply)
+{
+    pvLength[ply] = ply;
+    nodes++;
+    SEARCH_STAT(stats.nodes.add());
+
+    if(ply > 0 && board.isDraw()) return VALUE_DRAW;
+
+    if(ply >= MAX_PLY - 1) return Eval::evaluate(board);
+    if(depth <= 0) return qsearch(alpha, beta, ply);
+
+    const SearchOptions& options = limits.options;
+    bool pvNode = beta - alpha > 1;
+    int originalAlpha = alpha;
+    // set while searching this node again without the transposition table move (singular extension search).
+    Move excludedMove = excludedMoves[ply];
+
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    Color them = board.getOppositeColor(us);
+    bool inCheck = board.kingInCheck(us);
+
+    // a deep enough result from an earlier search of this position can end the search right here.
+    // pv nodes are always searched, so the principal variation stays complete.
+    TTData ttData;
+    SEARCH_STAT(stats.ttProbes.add());
+    bool ttHit = TT.probe(board.getKey(), ttData);
+    int ttScore = 0;
+    if(ttHit)
+    {
+        SEARCH_STAT(stats.ttHits.add());
+        ttScore = valueFromTT(ttData.score, ply);
+
+        // the stored result includes the excluded move, so it says nothing about the search without it.
+        if(!pvNode && excludedMove == MOVE_NONE && ttData.depth >= depth
+            && (ttData.bound == BOUND_EXACT
+                || (ttData.bound == BOUND_LOWER && ttScore >= beta)
+                || (ttData.bound == BOUND_UPPER && ttScore <= alpha)))
+        {
+            SEARCH_STAT(stats.ttCutoffs.add());
+            return ttScore;
+        }
+    }
+    Move ttMove = ttHit ? ttData.move : MOVE_NONE;
+
+    // the static evaluation means nothing when in check, none of the pruning below is done then.
+    int staticEval = -VALUE_INFINITE;
+    if(!inCheck)
+        staticEval = ttHit ? ttData.eval : Eval::evaluate(board);
+
+    // reverse futility pruning: when the position is far enough above beta, a quiet move will not bring it back below.
+    if(options.reverseFutilityPruning && !pvNode && !inCheck && excludedMove == MOVE_NONE
+        && depth <= REVERSE_FUTILITY_DEPTH && std::abs(beta) < VALUE_MATE_IN_MAX_PLY
+        && staticEval - REVERSE_FUTILITY_MARGIN * depth >= beta)
+        return staticEval;
+
+    // null move pruning: if passing the turn still fails high, a real move will almost always fail high too.
+    // without pieces other than pawns zugzwang is common, passing would then be the best move.
+    BitBoard nonPawnMaterial = board.getBoard(us) & ~(board.boardinfo.pawns | board.boardinfo.kings);
+    if(options.nullMovePruning && !pvNode && !inCheck && excludedMove == MOVE_NONE
+        && depth >= 3 && ply >= nullMoveMinPly && ply > 0 && currentMove[ply - 1] != MOVE_NONE
+        && staticEval >= beta && nonPawnMaterial)
+    {
+        int reduction = 3 + depth / 4;
+
+        board.pushNullMove();
+        currentMove[ply] = MOVE_NONE;
+        int score = -negamax(-beta, -beta + 1, depth - 1 - reduction, ply + 1);
+        board.popNullMove();
+
+        if(stopped) return 0;
+
+        if(score >= beta)
+        {
+            // a mate found after passing the turn is not proven.
+            if(score >= VALUE_MATE_IN_MAX_PLY) score = beta;
+
+            if(depth < NULL_MOVE_VERIFICATION_DEPTH) return score;
+
+            // deep null move cutoffs are verified by a reduced search of this node without null moves
+            // in the next plies, so a zugzwang does not cut off a large subtree.
+            // an outer verification may still be running, its limit is restored afterwards.
+            int previousMinPly = nullMoveMinPly;
+            nullMoveMinPly = ply + 3 * (depth - reduction) / 4;
+            int verification = negamax(beta - 1, beta, depth - reduction, ply);
+            nullMoveMinPly = previousMinPly;
+            pvLength[ply] = ply;
+
+            if(stopped) return 0;
+            if(verification >= beta) return score;
+        }
+    }
+
+    // the history rows of the moves one and two plies ago, and the move that refuted the previous move before.
+    const PieceToHistory* continuation[2] = {nullptr, nullptr};
+    for(int i = 0; i < 2; i++)
+    {
+        if(ply > i && currentMove[ply - 1 - i] != MOVE_NONE)
+            continuation[i] = &history.continuationHistory[movedPiece[ply - 1 - i]][to_Square(currentMove[ply - 1 - i])];
+    }
+    Move counterMove = MOVE_NONE;
+    if(ply > 0 && currentMove[ply - 1] != MOVE_NONE)
+        counterMove = history.counterMoves[movedPiece[ply - 1]][to_Square(currentMove[ply - 1])];
+
+    MovePicker picker(board, ttMove, killers[ply], counterMove, history, continuation);
+
+    int bestScore = -VALUE_INFINITE;
+    Move bestMove = MOVE_NONE;
+    int legalMoves = 0;
+
+    // quiet moves that did not cause a cutoff get a malus once another quiet move does.
+    Move quietsSearched[64];
+    int quietCount = 0;
+
+    Move move;
+    while((move = picker.nextMove()) != MOVE_NONE)
+    {
+        if(move == excludedMove) continue;
+        if(ply == 0 && std::find(pvLineMoves.begin(), pvLineMoves.end(), move) != pvLineMoves.end()) continue;
+
+        bool quiet = isQuiet(board, move);
+        int from = from_Square(move);
+        int piece = pieceIndex(us, board.getPieceTypeOnSquare(from));
+        int historyScore = history.mainHistory[us][from][to_Square(move)];
+
+        // singular extension: when every other move fails low against a bound a bit below the table score,
+        // the table move is the only good move here and is searched one ply deeper. like check extensions,
+        // it stops at twice the iteration depth.
+        int extension = 0;
+        if(options.singularExtensions && move == ttMove && ply > 0 && ply < 2 * rootDepth
+            && excludedMove == MOVE_NONE && depth >= SINGULAR_DEPTH && (ttData.bound & BOUND_LOWER) && ttData.depth >= depth - 3
+            && std::abs(ttScore) < VALUE_MATE_IN_MAX_PLY)
+        {
+            int singularBeta = ttScore - 2 * depth;
+
+            excludedMoves[ply] = move;
+            int score = negamax(singularBeta - 1, singularBeta, (depth - 1) / 2, ply);
+            excludedMoves[ply] = MOVE_NONE;
+            pvLength[ply] = ply;
+
+            if(stopped) return 0;
+            if(score < singularBeta) extension = 1;
+        }
+
+        board.pushMove(move);
+
+        // pseudo-legal moves that leave our king in check are skipped here instead of in the move generator.
+        if(board.kingInCheck(us))
+        {
+            board.popMove();
+            continue;
+        }
+        legalMoves++;
+        currentMove[ply] = move;
+        movedPiece[ply] = piece;
+
+        bool givesCheck = board.kingInCheck(them);
+
+        // late quiet moves of non-pv nodes are pruned once a move has been searched that does not get mated.
+        if(!pvNode && !inCheck && !givesCheck && quiet && bestScore > -VALUE_MATE_IN_MAX_PLY)
+        {
+            // late move pruning: with good move ordering, a quiet move this late is very unlikely to be the best move.
+            if(options.lateMovePruning && depth <= LATE_MOVE_PRUNING_DEPTH && quietCount >= 3 + depth * depth)
+            {
+                board.popMove();
+                picker.skipQuiets = true;
+                continue;
+            }
+
+            // futility pruning: a quiet move hardly changes the evaluation, so it cannot raise it above alpha.
+            if(options.futilityPruning && depth <= FUTILITY_DEPTH && staticEval + FUTILITY_MARGIN * (depth + 1) <= alpha)
+            {
+                board.popMove();
+                continue;
+            }
+        }
+
+        // check extension: the reply is forced, so searching it one ply deeper costs little. the extensions are
+        // limited to twice the iteration depth, otherwise a long series of checks could keep extending.
+        if(options.checkExtensions && givesCheck && ply < 2 * rootDepth)
+            extension = 1;
+
+        int newDepth = depth - 1 + extension;
+
+        // principal variation search: the first move gets the full window, the others are first
+        // searched with a null window to prove they are worse, and only re-searched when they are not.
+        int score;
+        if(legalMoves == 1)
+            score = -negamax(-beta, -alpha, newDepth, ply + 1);
+        else
+        {
+            // late move reductions: late quiet moves are searched less deep, and only searched again at
+            // full depth when they turn out better than alpha.
+            int reduction = 0;
+            if(options.lateMoveReductions && depth >= 3 && quiet && !inCheck && !givesCheck)
+            {
+                reduction = reductions[std::min(depth, MAX_PLY - 1)][std::min(legalMoves, 63)];
+                if(pvNode) reduction--;
+                reduction -= historyScore / 8192;
+                reduction = std::clamp(reduction, 0, newDepth - 1);
+
+                SEARCH_STAT(stats.reducedMoves.add());
+                SEARCH_STAT(stats.reductionPlies.add(reduction));
+            }
+
+            score = -negamax(-alpha - 1, -alpha, newDepth - reduction, ply + 1);
+            if(score > alpha && reduction > 0)
+                score = -negamax(-alpha - 1, -alpha, newDepth, ply + 1);
+            if(score > alpha && score < beta)
+                score = -negamax(-beta, -alpha, newDepth, ply + 1);
+        }
+        board.popMove();
+
+        checkLimits();
+        if(stopped) return 0;
+
+        if(score > bestScore)
+        {
+            bestScore = score;
+            bestMove = move;
+
+            if(score > alpha)
+            {
+                alpha = score;
+
+                // the best line from here is this move followed by the best line of the child.
+                pvTable[ply][ply] = move;
+                for(int i = ply + 1; i < pvLength[ply + 1]; i++)
+                    pvTable[ply][i] = pvTable[ply + 1][i];
+                pvLength[ply] = pvLength[ply + 1];
+
+                if(alpha >= beta)
+                {
+                    SEARCH_STAT(stats.betaCutoffs.add());
+                    SEARCH_STAT(if(legalMoves == 1) stats.firstMoveCutoffs.add());
+
+                    if(quiet) updateQuietStats(move, quietsSearched, quietCount, ply, depth);
+                    break;
+                }
+            }
+        }
+
+        if(quiet && quietCount < 64)
+            quietsSearched[quietCount++] = move;
+    }
+
+    // no legal moves means checkmate or stalemate, mates closer to the root score higher.
+    // when the only legal move was excluded this is neither, the node just fails low.
+    if(legalMoves == 0)
+    {
+        if(excludedMove != MOVE_NONE) return alpha;
+        return inCheck ? -VALUE_MATE + ply : VALUE_DRAW;
+    }
+
+    // the root result of a later MultiPV line leaves out the best moves, so it is not stored either.
+    if(excludedMove == MOVE_NONE && (ply > 0 || pvLineMoves.empty()))
+    {
+        Bound bound = bestScore >= beta ? BOUND_LOWER : (bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER);
+        TT.store(board.getKey(), bestMove, valueToTT(bestScore, ply), inCheck ? 0 : staticEval, depth, bound);
+    }
+
+    return bestScore;
+}
+
+int Search::SearchWorker::qsearch(int alpha, int beta, int ply)
+{
+    pvLength[ply] = ply;
+    nodes++;
+    SEARCH_STAT(stats.qnodes.add());
+
+    if(board.isDraw()) return VALUE_DRAW;
+    if(ply >= MAX_PLY - 1) return Eval::evaluate(board);
+
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    bool inCheck = board.kingInCheck(us);
+
+    // the side to move does not have to capture, so the static evaluation is a lower bound (stand pat).
+    // in check this does not hold, all evasions are searched instead.
+    int standPat = -VALUE_INFINITE;
+    int bestScore = -VALUE_INFINITE;
+    if(!inCheck)
+    {
+        standPat = Eval::evaluate(board);
+        if(standPat >= beta) return standPat;
+        if(standPat > alpha) alpha = standPat;
+        bestScore = standPat;
+    }
+
+    MoveList moves;
+    if(inCheck)
+        genPseudoLegalMoves(board, moves);
+    else
+        genCaptureMoves(board, moves);
+
+    ExtMove scoredMoves[256];
+    int moveCount = moves.size();
+    for(int i = 0; i < moveCount; i++)
+        scoredMoves[i] = {moves[i], captureScore(board, moves[i])};
+    std::sort(scoredMoves, scoredMoves + moveCount, [](const ExtMove& a, const ExtMove& b) { return a.score > b.score; });
+
+    int legalMoves = 0;
+
+    for(int i = 0; i < moveCount; i++)
+    {
+        Move move = scoredMoves[i];
+
+        if(!inCheck)
+        {
+            // underpromotions almost never matter in a capture sequence.
+            bool promotion = moveType(move) == PROMOTION;
+            if(promotion && movePromotionType(move) != QUEEN) continue;
+
+            // delta pruning: even winning the captured piece for free would not raise alpha.
+            if(!promotion)
+            {
+                PieceType captured = moveType(move) == ENPASSANT ? PAWN : board.getPieceTypeOnSquare(to_Square(move));
+                if(standPat + Eval::pieceValues[captured] + DELTA_MARGIN <= alpha) continue;
+            }
+
+            // captures that lose material in the exchange are not worth searching.
+            if(see(board, move) < 0) continue;
+        }
+
+        board.pushMove(move);
+
+        if(board.kingInCheck(us))
+        {
+            board.popMove();
+            continue;
+        }
+        legalMoves++;
+
+        int score = -qsearch(-beta, -alpha, ply + 1);
+        board.popMove();
+
+        checkLimits();
+        if(stopped) return 0;
+
+        if(score > bestScore)
+        {
+            bestScore = score;
+
+            if(score > alpha)
+            {
+                alpha = score;
+
+                pvTable[ply][ply] = move;
+                for(int j = ply + 1; j < pvLength[ply + 1]; j++)
+                    pvTable[ply][j] = pvTable[ply + 1][j];
+                pvLength[ply] = pvLength[ply + 1];
+
+                if(alpha >= beta) break;
+            }
+        }
+    }
+
+    if(inCheck && legalMoves == 0) return -VALUE_MATE + ply;
+
+    return bestScore;
+}
+
+void Search::SearchWorker::updateQuietStats(Move bestMove, const Move* quiets, int quietCount, int ply, int depth)
+{
+    Color us = board.getWhiteToMove() ? WHITE : BLACK;
+    // cutoffs deep in the tree save more work, so they count more.
+    int bonus = std::min(32 * depth * depth, 1536);
+
+    auto update = [&](Move move, int amount)
+    {
+        int from = from_Square(move);
+        int to = to_Square(move);
+        int piece = pieceIndex(us, board.getPieceTypeOnSquare(from));
+
+        updateHistory(history.mainHistory[us][from][to], amount);
+        for(int i = 0; i < 2; i++)
+        {
+            if(ply > i && currentMove[ply - 1 - i] != MOVE_NONE)
+                updateHistory(history.continuationHistory[movedPiece[ply - 1 - i]][to_Square(currentMove[ply - 1 - i])][piece][to], amount);
+        }
+    };
+
+    update(bestMove, bonus);
+    for(int i = 0; i < quietCount; i++)
+        update(quiets[i], -bonus);
+
+    if(killers[ply][0] != bestMove)
+    {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = bestMove;
+    }
+
+    if(ply > 0 && currentMove[ply - 1] != MOVE_NONE)
+        history.counterMoves[movedPiece[ply - 1]][to_Square(currentMove[ply - 1])] = bestMove;
+}
+
+void Search::SearchWorker::checkLimits()
+{
+    if(nodes - reportedNodes < LIMIT_CHECK_INTERVAL) return;
+
+    U64 totalNodes = shared->nodes.fetch_add(nodes - reportedNodes, std::memory_order_relaxed) + nodes - reportedNodes;
+    reportedNodes = nodes;
+
+    if(!shared->pondering.load(std::memory_order_relaxed))
+    {
+        if(limits.nodes && totalNodes >= limits.nodes)
+            shared->stop.store(true, std::memory_order_relaxed);
+
+        if(threadId == 0 && completedDepth > 0 && shared->time.enabled && shared->time.elapsed() >= shared->time.maximumTime)
+            shared->stop.store(true, std::memory_order_relaxed);
+    }
+
+    if(shared->stop.load(std::memory_order_relaxed))
+        stopped = true;
+}
+
+SearchResult Search::search(const ChessBoard& board, SearchLimits limits)
+{
+    SharedState shared;
+    return search(board, limits, shared);
+}
+
+SearchResult Search::search(const ChessBoard& board, SearchLimits limits, SharedState& shared)
+{
+    // the clock starts before anything is allocated, the time spent on that counts against the search.
+    shared.time.init(limits, board.boardinfo.whiteToMove ? WHITE : BLACK);
+
+    // only when init was not called.
+    allocateTables();
+    TT.newSearch();
+
+    int threadCount = std::max(1, limits.threads);
+
+    // the workers are big (pv tables and histories), so they live on the heap instead of the thread stacks.
+    std::vector<std::unique_ptr<SearchWorker>> workers;
+    {
+        std::lock_guard<std::mutex> lock(workerPoolMutex);
+        while(!workerPool.empty() && (int)workers.size() < threadCount)
+        {
+            workers.push_back(std::move(workerPool.back()));
+            workerPool.pop_back();
+        }
+    }
+
+    for(int i = 0; i < threadCount; i++)
+    {
+        if(i < (int)workers.size())
+            workers[i]->reset(board, limits, &shared, i);
+        else
+            workers.emplace_back(new SearchWorker(board, limits, &shared, i));
+        workers.back()->board.prefetchTable = &TT;
+        if(!evalCache.empty())
+            workers.back()->board.evalCache = &evalCache;
+        SEARCH_STAT(shared.workers.push_back(workers.back().get()));
+    }
+
+    std::vector<SearchResult> results(threadCount);
+    std::vector<std::thread> helpers;
+    for(int i = 1; i < threadCount; i++)
+        helpers.emplace_back([&workers, &results, i]() { results[i] = workers[i]->iterate(); });
+
+    // the main thread searches too, once it is done the helpers are stopped.
+    results[0] = workers[0]->iterate();
+    shared.stop.store(true, std::memory_order_relaxed);
+
+    for(std::thread &helper : helpers)
+        helper.join();
+
+    // helpers may have finished a deeper iteration than the main thread, the deepest result is the most reliable.
+    SearchResult best = results[0];
+    for(int i = 1; i < threadCount; i++)
+    {
+        if(results[i].depth > best.depth && results[i].bestMove != MOVE_NONE)
+            best = results[i];
+    }
+
+    best.nodes = 0;
+    for(SearchResult &result : results)
+        best.nodes += result.nodes;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.time.startTime).count();
+    best.nps = seconds > 0 ? (U64)(best.nodes / seconds) : 0;
+    best.hashfull = TT.hashfull();
+
+#ifdef SEARCH_STATS
+    best.stats = shared.collectStats();
+    std::cerr << best.stats.toJson() << std::endl;
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(workerPoolMutex);
+        for(std::unique_ptr<SearchWorker> &worker : workers)
+            workerPool.push_back(std::move(worker));
+    }
+
+    return best;
+}
+
+int Search::see(ChessBoard& board, Move move)
+{
+    // the king gets a value higher than everything else can win, so capturing into a defended square never pays off.
+    static const int seeValues[6] = {Eval::pieceValues[PAWN], Eval::pieceValues[KNIGHT], Eval::pieceValues[BISHOP],
+        Eval::pieceValues[ROOK], Eval::pieceValues[QUEEN], 20000};
+
+    MoveType type = moveType(move);
+    if(type == CASTLING) return 0;
+
+    int from = from_Square(move);
+    int to = to_Square(move);
+
+    PieceType attacker = board.getPieceTypeOnSquare(from);
+    PieceType captured = board.getPieceTypeOnSquare(to);
+
+    BitBoard occupied = board.getBlockers();
+    occupied.set(from, false);
+
+    // gain[d] is the material balance after d recaptures, from the side that made capture d.
+    int gain[32];
+    int d = 0;
+    gain[0] = captured == TYPE_UD ? 0 : seeValues[captured];
+
+    if(type == ENPASSANT)
+    {
+        gain[0] = seeValues[PAWN];
+        // the captured pawn stands next to our pawn, on the rank it moved from.
+        occupied.set((from / 8) * 8 + to % 8, false);
+    }
+    else if(type == PROMOTION)
+    {
+        attacker = movePromotionType(move);
+        gain[0] += seeValues[attacker] - seeValues[PAWN];
+    }
+
+    Color side = board.getWhiteToMove() ? BLACK : WHITE;
+
+    while(true)
+    {
+        // the attackers are looked up again every time, so sliders behind a piece that just captured join in (x-rays).
+        BitBoard attackers = board.attackersTo(to, occupied) & occupied & board.getBoard(side);
+        if(!attackers) break;
+
+        int attackerSquare = 0;
+        PieceType nextAttacker = PAWN;
+        for(int p = PAWN; p <= KING; p++)
+        {
+            BitBoard pieces = attackers & *board.getPieceBoard(PieceType(p));
+            if(pieces)
+            {
+                attackerSquare = pieces.lsb();
+                nextAttacker = PieceType(p);
+                break;
+            }
+        }
+
+        // once recapturing cannot win anything for this side, it stops and the exchange is settled.
+        int recapture = seeValues[attacker] - gain[d];
+        if(std::max(-gain[d], recapture) < 0) break;
+        gain[++d] = recapture;
+
+        occupied.set(attackerSquare, false);
+        attacker = nextAttacker;
+        side = board.getOppositeColor(side);
+    }
+
+    // each side may also stop recapturing, the result is propagated back to the first capture.
+    while(d > 0)
+    {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+        d--;
+    }
+
+    return gain[0];
+}
+
+int16_t Search::captureScore(ChessBoard& board, Move move)
+{
+    PieceType attacker = board.getPieceTypeOnSquare(from_Square(move));
+    PieceType victim = moveType(move) == ENPASSANT ? PAWN : board.getPieceTypeOnSquare(to_Square(move));
+
+    int score = 0;
+    if(victim != TYPE_UD && moveType(move) != CASTLING)
+        score = Eval::pieceValues[victim] * 8 - attacker;
+    if(moveType(move) == PROMOTION)
+        score += Eval::pieceValues[movePromotionType(move)];
+
+    return score;
+}
+
+void Search::initReductions()
+{
+    // reductions grow slowly with both the depth and the move number.
+    for(int depth = 0; depth < MAX_PLY; depth++)
+    {
+        for(int moveNumber = 0; moveNumber < 64; moveNumber++)
+        {
+            if(depth == 0 || moveNumber == 0)
+                reductions[depth][moveNumber] = 0;
+            else
+                reductions[depth][moveNumber] = int(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+        }
+    }
+}
+
+#ifdef SEARCH_STATS
+SearchStats Search::SharedState::collectStats() const
+{
+    SearchStats stats;
+    for(const SearchWorker * worker : workers)
+    {
+        stats.add(worker->stats);
+        stats.pawnProbes += worker->pawnTable.probes.get();
+        stats.pawnHits += worker->pawnTable.hits.get();
+    }
+    return stats;
+}
+#endif
+
+void Search::init()
+{
+    initReductions();
+    allocateTables();
+}
+
+Move Search::bestMoveWithin(const ChessBoard& board, int64_t milliseconds)
+{
+    SearchLimits limits;
+    limits.movetime = milliseconds;
+
+    return search(board, limits).bestMove;
+}
+
+void Search::setHashSize(size_t megabytes)
+{
+    TT.resize(megabytes);
+}
+
+void Search::clearHash()
+{
+    TT.clear();
+}
+
+void Search::setEvalCacheSize(size_t megabytes)
+{
+    evalCache.resize(megabytes);
+    evalCacheSizeSet = true;
+}
+
+int Search::valueToTT(int score, int ply)
+{
+    if(score >= VALUE_MATE_IN_MAX_PLY) return score + ply;
+    if(score <= -VALUE_MATE_IN_MAX_PLY) return score - ply;
+    return score;
+}
+
+int Search::valueFromTT(int score, int ply)
+{
+    if(score >= VALUE_MATE_IN_MAX_PLY) return score - ply;
+    if(score <= -VALUE_MATE_IN_MAX_PLY) return score + ply;
+    return score;
+}
+
+bool Search::isMateScore(int score)
+{
+    return std::abs(score) >= VALUE_MATE_IN_MAX_PLY;
+}
+
+int Search::mateIn(int score)
+{
+    // a mate at ply n takes (n + 1) / 2 of our moves.
+    if(score > 0) return (VALUE_MATE - score + 1) / 2;
+    return -(VALUE_MATE + score) / 2;
+}
@@ -0,0 +1,251 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <board.h>
+#include <move.h>
+#include <movegen.h>
+#include <tt.h>
+#include <movepick.h>
+#include <timeman.h>
+#include <stats.h>
+#include <nnue.h>
+#include <pawns.h>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace nnchesslib
+{
+    const int MAX_PLY = 128;
+
+    const int VALUE_DRAW = 0;
+    const int VALUE_MATE = 32000;
+    const int VALUE_INFINITE = 32001;
+    // Scores beyond this are mates found inside the search tree.
+    const int VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+
+    // Captures that cannot bring the score back above alpha even with this margin are skipped in the quiescence search.
+    const int DELTA_MARGIN = 200;
+
+    // The shared node count, node limit and clock are checked once every this many nodes.
+    const int LIMIT_CHECK_INTERVAL = 1024;
+
+    // Depth limits and margins of the selective search, see SearchOptions.
+    const int REVERSE_FUTILITY_DEPTH = 6;
+    const int REVERSE_FUTILITY_MARGIN = 80;
+    const int NULL_MOVE_VERIFICATION_DEPTH = 10;
+    const int FUTILITY_DEPTH = 6;
+    const int FUTILITY_MARGIN = 90;
+    const int LATE_MOVE_PRUNING_DEPTH = 5;
+    const int SINGULAR_DEPTH = 8;
+
+    // Selective search techniques, each can be turned off to measure what it costs or gains.
+    struct SearchOptions
+    {
+        // Skip a node when passing the turn still fails high, verified by a reduced search at high depths.
+        bool nullMovePruning = true;
+        // Search late quiet moves with less depth, by an amount from a log(depth) * log(move number) table.
+        bool lateMoveReductions = true;
+        // Skip quiet moves near the leaves when the static evaluation is far below alpha.
+        bool futilityPruning = true;
+        // Return the static evaluation near the leaves when it is far above beta.
+        bool reverseFutilityPruning = true;
+        // Skip the remaining quiet moves near the leaves once enough of them have been searched.
+        bool lateMovePruning = true;
+        // Search moves that give check one ply deeper.
+        bool checkExtensions = true;
+        // Search the transposition table move one ply deeper when all other moves are clearly worse.
+        bool singularExtensions = true;
+    };
+
+    struct SearchResult;
+
+    struct SearchLimits
+    {
+        // Maximum depth of iterative deepening.
+        int depth = MAX_PLY - 1;
+        // Stop after searching this many nodes (summed over all threads), 0 means no limit.
+        U64 nodes = 0;
+
+        // Remaining clock time and increment per move of both sides in milliseconds, 0 means no clock.
+        int64_t wtime = 0;
+        int64_t btime = 0;
+        int64_t winc = 0;
+        int64_t binc = 0;
+        // Moves until the next time control, 0 means the rest of the game has to be played on the clock.
+        int movestogo = 0;
+        // Fixed time for this move in milliseconds, 0 means no fixed time.
+        int64_t movetime = 0;
+        // Time kept in reserve for communication and starting the search, in milliseconds.
+        int64_t moveOverhead = 10;
+
+        // Number of search threads. Helper threads run Lazy SMP: they search the same position
+        // on their own board and only share the transposition table.
+        int threads = 1;
+        // Number of best root moves to search a full line and score for (MultiPV analysis).
+        int multiPV = 1;
+        SearchOptions options;
+        // Called by the main thread after every completed iteration, e.g. to show the lines while analysing.
+        std::function<void(const SearchResult&)> onIteration;
+    };
+
+    // One of the best lines found at the root.
+    struct PVLine
+    {
+        int score = 0;
+        std::vector<Move> pv;
+    };
+
+    struct SearchResult
+    {
+        Move bestMove = MOVE_NONE;
+        // Score in centipawns from the side to move, or a mate score (see Search::mateIn).
+        int score = 0;
+        // Depth of the last completed iteration.
+        int depth = 0;
+        // Principal variation, starting with bestMove.
+        std::vector<Move> pv;
+        // The best lines from best to worst, as many as SearchLimits::multiPV asks for (fewer when there are
+        // not enough legal moves). The first line is the same as score and pv.
+        std::vector<PVLine> lines;
+        U64 nodes = 0;
+        U64 nps = 0;
+        // Permille of the transposition table used.
+        int hashfull = 0;
+
+#ifdef SEARCH_STATS
+        // Statistics of all threads, only collected in builds with SEARCH_STATS defined.
+        SearchStats stats;
+#endif
+    };
+
+    namespace Search
+    {
+        class SearchWorker;
+
+        // State shared by all threads of one search.
+        struct SharedState
+        {
+            std::atomic<bool> stop{false};
+            // While pondering the search runs on the opponent's time, so no limits apply and the main thread does
+            // not finish before a ponderhit (or stop), even when it reached the depth limit.
+            std::atomic<bool> pondering{false};
+            // Workers add their node counts here in batches, so checking the node limit needs no locking per node.
+            std::atomic<U64> nodes{0};
+            // Only the main thread looks at the clock, the helpers follow its stop signal.
+            TimeManager time;
+
+#ifdef SEARCH_STATS
+            std::vector<SearchWorker*> workers;
+            // Adds up the statistics of all threads, also while they are still searching.
+            SearchStats collectStats() const;
+#endif
+        };
+
+        // State of a single search thread, all moves are made and unmade on its own copy of the board.
+        class SearchWorker
+        {
+            public:
+                ChessBoard board;
+                // Keeps the network the board evaluates with alive while it is searched, even if it is swapped out meanwhile.
+                std::shared_ptr<const NNUE::Network> network;
+                SearchLimits limits;
+                SharedState * shared;
+                // 0 is the main thread, helpers search with a depth offset to spread over the tree.
+                int threadId;
+
+                U64 nodes = 0;
+                U64 reportedNodes = 0;
+#ifdef SEARCH_STATS
+                ThreadStats stats;
+#endif
+                bool stopped = false;
+
+                // Triangular principal variation table, pvTable[ply] holds the best line from that ply.
+                Move pvTable[MAX_PLY][MAX_PLY];
+                int pvLength[MAX_PLY];
+
+                // Move ordering statistics, every thread learns its own.
+                SearchHistory history;
+                // Pawn structure cache of this thread.
+                PawnTable pawnTable;
+                // Two quiet moves per ply that recently caused a beta cutoff at that ply.
+                Move killers[MAX_PLY][2];
+                // The move made at each ply of the current line and the piece that made it, for the continuation history.
+                Move currentMove[MAX_PLY];
+                int movedPiece[MAX_PLY];
+                // The move left out at each ply during a singular extension search.
+                Move excludedMoves[MAX_PLY];
+                // Null moves are not tried before this ply while a null move cutoff is being verified.
+                int nullMoveMinPly = 0;
+                // Depth of the current iteration.
+                int rootDepth = 0;
+                // Root moves that already head a line of the current iteration, the next line is searched without them.
+                std::vector<Move> pvLineMoves;
+
+                // Depth of the last completed iteration, time limits only apply once there is a move to return.
+                int completedDepth = 0;
+
+                SearchWorker(const ChessBoard& board, SearchLimits limits, SharedState * shared, int threadId);
+                // Prepares the worker for a new search. Workers are kept between searches, allocating them costs
+                // more than a short search. The pawn table keeps its entries, they do not depend on the search.
+                void reset(const ChessBoard& board, SearchLimits limits, SharedState * shared, int threadId);
+
+                // Runs iterative deepening up to the depth limit.
+                SearchResult iterate();
+                // Negamax alpha-beta search, returns the score from the side to move.
+                int negamax(int alpha, int beta, int depth, int ply);
+                // Searches only captures and promotions until the position is quiet, so the leaves are not evaluated in the middle of an exchange.
+                int qsearch(int alpha, int beta, int ply);
+
+                // Rewards a quiet move that caused a beta cutoff and punishes the quiet moves searched before it.
+                void updateQuietStats(Move bestMove, const Move* quiets, int quietCount, int ply, int depth);
+                // Checks the stop signal, node limit and clock every LIMIT_CHECK_INTERVAL nodes.
+                void checkLimits();
+        };
+
+        // Late move reductions indexed by [depth][move number].
+        extern int reductions[MAX_PLY][64];
+        // Fills the late move reduction table.
+        void initReductions();
+        // Fills the reduction table and allocates the transposition table and the evaluation cache at their
+        // default sizes (unless sizes were set before), so the first search does not spend its time on that.
+        void init();
+
+        // Searches the position with iterative deepening and returns the result of the last completed iteration.
+        SearchResult search(const ChessBoard& board, SearchLimits limits);
+        // Same as above, with the shared state given by the caller so it can be stopped or converted from pondering
+        // from another thread. A state can only be used for one search.
+        SearchResult search(const ChessBoard& board, SearchLimits limits, SharedState& shared);
+
+        // Static exchange evaluation: the material won or lost on the target square when both sides keep
+        // recapturing with their least valuable piece, in centipawns.
+        int see(ChessBoard& board, Move move);
+        // Most valuable victim, least valuable attacker ordering score of a capture or promotion.
+        int16_t captureScore(ChessBoard& board, Move move);
+
+        // Returns the best move found within the given number of milliseconds, e.g. for a server with a hard deadline per move.
+        Move bestMoveWithin(const ChessBoard& board, int64_t milliseconds);
+
+        // Sets the size of the shared transposition table in megabytes.
+        void setHashSize(size_t megabytes);
+        // Clears the shared transposition table, e.g. before a new game.
+        void clearHash();
+        // Sets the size of the shared evaluation cache in megabytes, 0 turns it off. It is 4 MB until this is called.
+        // Both tables are allocated right away, by init or on the first search when neither was called.
+        void setEvalCacheSize(size_t megabytes);
+
+        // Mate scores are stored relative to the node instead of the root, so they stay correct when found at another ply.
+        int valueToTT(int score, int ply);
+        int valueFromTT(int score, int ply);
+
+        // Returns true for scores that mean a forced mate was found.
+        bool isMateScore(int score);
+        // Returns the number of moves until mate, negative when the side to move gets mated.
+        int mateIn(int score);
+    }
+}
+
+#endif
@@ -0,0 +1,315 @@
+// Simd.cpp | Quantized network kernels for sse4.1 and avx2 with a scalar fallback.
+
+#include <simd.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace nnchesslib;
+
+static void addRowScalar(int16_t * values, const int16_t * row, int length)
+{
+    for(int i = 0; i < length; i++)
+        values[i] += row[i];
+}
+
+static void subtractRowScalar(int16_t * values, const int16_t * row, int length)
+{
+    for(int i = 0; i < length; i++)
+        values[i] -= row[i];
+}
+
+static void addSubtractRowScalar(int16_t * values, const int16_t * added, const int16_t * removed, int length)
+{
+    for(int i = 0; i < length; i++)
+        values[i] += added[i] - removed[i];
+}
+
+static void clippedReluScalar(const int16_t * input, uint8_t * output, int length)
+{
+    for(int i = 0; i < length; i++)
+        output[i] = (uint8_t)std::clamp<int>(input[i], 0, 127);
+}
+
+static int32_t dotScalar(const uint8_t * input, const int8_t * weights, int length)
+{
+    int32_t sum = 0;
+    for(int i = 0; i < length; i++)
+        sum += input[i] * weights[i];
+    return sum;
+}
+
+static void expandBitsScalar(uint64_t bits, uint8_t * bytes)
+{
+    for(int i = 0; i < 64; i++)
+        bytes[i] = bits >> i & 1;
+}
+
+static void expandBitsFloatScalar(uint64_t bits, float * values)
+{
+    for(int i = 0; i < 64; i++)
+        values[i] = bits >> i & 1;
+}
+
+#ifdef SIMD_X86
+
+// the vector functions are compiled for their own instruction set, so the rest of the
+// library keeps working on cpus without it. the tails go through the scalar functions.
+
+__attribute__((target("sse4.1")))
+static void addRowSse(int16_t * values, const int16_t * row, int length)
+{
+    int i = 0;
+    for(; i + 8 <= length; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(row + i));
+        _mm_storeu_si128((__m128i *)(values + i), _mm_add_epi16(v, r));
+    }
+    addRowScalar(values + i, row + i, length - i);
+}
+
+__attribute__((target("sse4.1")))
+static void subtractRowSse(int16_t * values, const int16_t * row, int length)
+{
+    int i = 0;
+    for(; i + 8 <= length; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(row + i));
+        _mm_storeu_si128((__m128i *)(values + i), _mm_sub_epi16(v, r));
+    }
+    subtractRowScalar(values + i, row + i, length - i);
+}
+
+__attribute__((target("sse4.1")))
+static void addSubtractRowSse(int16_t * values, const int16_t * added, const int16_t * removed, int length)
+{
+    int i = 0;
+    for(; i + 8 <= length; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+        __m128i a = _mm_loadu_si128((const __m128i *)(added + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(removed + i));
+        _mm_storeu_si128((__m128i *)(values + i), _mm_sub_epi16(_mm_add_epi16(v, a), r));
+    }
+    addSubtractRowScalar(values + i, added + i, removed + i, length - i);
+}
+
+__attribute__((target("sse4.1")))
+static void clippedReluSse(const int16_t * input, uint8_t * output, int length)
+{
+    int i = 0;
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(input + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(input + i + 8));
+        // packing saturates to [-128, 127], the max with zero cuts off the negative part.
+        __m128i packed = _mm_packs_epi16(a, b);
+        _mm_storeu_si128((__m128i *)(output + i), _mm_max_epi8(packed, zero));
+    }
+    clippedReluScalar(input + i, output + i, length - i);
+}
+
+__attribute__((target("sse4.1")))
+static int32_t dotSse(const uint8_t * input, const int8_t * weights, int length)
+{
+    int i = 0;
+    __m128i sum = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(input + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(weights + i));
+        // pairs of products are added into int16, they cannot saturate since the inputs are at most 127.
+        __m128i products = _mm_maddubs_epi16(in, w);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum) + dotScalar(input + i, weights + i, length - i);
+}
+
+__attribute__((target("sse4.1")))
+static void expandBitsSse(uint64_t bits, uint8_t * bytes)
+{
+    // every byte of the bitboard is copied to 8 lanes, each lane keeps its own bit.
+    const __m128i spread = _mm_set_epi8(1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask = _mm_set1_epi64x(0x8040201008040201LL);
+    const __m128i one = _mm_set1_epi8(1);
+    for(int i = 0; i < 64; i += 16)
+    {
+        __m128i source = _mm_set1_epi16((short)(bits >> i));
+        __m128i lanes = _mm_and_si128(_mm_shuffle_epi8(source, spread), mask);
+        _mm_storeu_si128((__m128i *)(bytes + i), _mm_and_si128(_mm_cmpeq_epi8(lanes, mask), one));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void expandBitsFloatSse(uint64_t bits, float * values)
+{
+    alignas(16) uint8_t bytes[64];
+    expandBitsSse(bits, bytes);
+    for(int i = 0; i < 64; i += 4)
+    {
+        __m128i lanes = _mm_cvtepu8_epi32(_mm_loadu_si32(bytes + i));
+        _mm_storeu_ps(values + i, _mm_cvtepi32_ps(lanes));
+    }
+}
+
+__attribute__((target("avx2")))
+static void addRowAvx2(int16_t * values, const int16_t * row, int length)
+{
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        _mm256_storeu_si256((__m256i *)(values + i), _mm256_add_epi16(v, r));
+    }
+    addRowScalar(values + i, row + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static void subtractRowAvx2(int16_t * values, const int16_t * row, int length)
+{
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        _mm256_storeu_si256((__m256i *)(values + i), _mm256_sub_epi16(v, r));
+    }
+    subtractRowScalar(values + i, row + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static void addSubtractRowAvx2(int16_t * values, const int16_t * added, const int16_t * removed, int length)
+{
+    int i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+        __m256i a = _mm256_loadu_si256((const __m256i *)(added + i));
+        __m256i r = _mm256_loadu_si256((const __m256i *)(removed + i));
+        _mm256_storeu_si256((__m256i *)(values + i), _mm256_sub_epi16(_mm256_add_epi16(v, a), r));
+    }
+    addSubtractRowScalar(values + i, added + i, removed + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static void clippedReluAvx2(const int16_t * input, uint8_t * output, int length)
+{
+    int i = 0;
+    const __m256i zero = _mm256_setzero_si256();
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(input + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(input + i + 16));
+        // avx2 packs within 128 bit lanes, the permute puts the quarters back in order.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(output + i), _mm256_max_epi8(packed, zero));
+    }
+    clippedReluScalar(input + i, output + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static int32_t dotAvx2(const uint8_t * input, const int8_t * weights, int length)
+{
+    int i = 0;
+    __m256i sum = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    for(; i + 32 <= length; i += 32)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(input + i));
+        __m256i w = _mm256_loadu_si256((const __m256i *)(weights + i));
+        __m256i products = _mm256_maddubs_epi16(in, w);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half) + dotScalar(input + i, weights + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static void expandBitsAvx2(uint64_t bits, uint8_t * bytes)
+{
+    // shuffles stay within 128 bit lanes, the low lane spreads bytes 0 and 1 and the high lane bytes 2 and 3.
+    const __m256i spread = _mm256_set_epi8(3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2,
+                                           1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask = _mm256_set1_epi64x(0x8040201008040201LL);
+    const __m256i one = _mm256_set1_epi8(1);
+    for(int i = 0; i < 64; i += 32)
+    {
+        __m256i source = _mm256_set1_epi32((int)(bits >> i));
+        __m256i lanes = _mm256_and_si256(_mm256_shuffle_epi8(source, spread), mask);
+        _mm256_storeu_si256((__m256i *)(bytes + i), _mm256_and_si256(_mm256_cmpeq_epi8(lanes, mask), one));
+    }
+}
+
+__attribute__((target("avx2")))
+static void expandBitsFloatAvx2(uint64_t bits, float * values)
+{
+    alignas(32) uint8_t bytes[64];
+    expandBitsAvx2(bits, bytes);
+    for(int i = 0; i < 64; i += 8)
+    {
+        __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(bytes + i)));
+        _mm256_storeu_ps(values + i, _mm256_cvtepi32_ps(lanes));
+    }
+}
+
+#endif
+
+static const Simd::Kernels allKernels[] = {
+    {Simd::SCALAR, "scalar", addRowScalar, subtractRowScalar, addSubtractRowScalar, clippedReluScalar, dotScalar,
+        expandBitsScalar, expandBitsFloatScalar},
+#ifdef SIMD_X86
+    {Simd::SSE41, "sse4.1", addRowSse, subtractRowSse, addSubtractRowSse, clippedReluSse, dotSse,
+        expandBitsSse, expandBitsFloatSse},
+    {Simd::AVX2, "avx2", addRowAvx2, subtractRowAvx2, addSubtractRowAvx2, clippedReluAvx2, dotAvx2,
+        expandBitsAvx2, expandBitsFloatAvx2},
+#endif
+};
+
+static const Simd::Kernels * activeKernels = &allKernels[Simd::detectLevel()];
+
+bool Simd::supported(Level level)
+{
+#ifdef SIMD_X86
+    // the kernels are picked during static initialization, before the runtime would have done this.
+    __builtin_cpu_init();
+    if(level == AVX2) return __builtin_cpu_supports("avx2");
+    if(level == SSE41) return __builtin_cpu_supports("sse4.1");
+#endif
+    return level == SCALAR;
+}
+
+Simd::Level Simd::detectLevel()
+{
+    if(supported(AVX2)) return AVX2;
+    if(supported(SSE41)) return SSE41;
+    return SCALAR;
+}
+
+const Simd::Kernels& Simd::kernels(Level level)
+{
+    return allKernels[level];
+}
+
+const Simd::Kernels& Simd::kernels()
+{
+    return *activeKernels;
+}
+
+bool Simd::setLevel(Level level)
+{
+    if(!supported(level)) return false;
+    activeKernels = &allKernels[level];
+    return true;
+}
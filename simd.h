@@ -0,0 +1,53 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstdint>
+
+namespace nnchesslib
+{
+    namespace Simd
+    {
+        // Instruction sets the kernels are available for, from slowest to fastest.
+        enum Level
+        {
+            SCALAR, SSE41, AVX2
+        };
+
+        // Kernels of the network and the tensor encoder, every level gives bit-identical results.
+        // Lengths should be multiples of 32 to stay on the vector paths, the rest is handled one element at a time.
+        struct Kernels
+        {
+            Level level;
+            const char * name;
+
+            // values[i] += row[i]
+            void (*addRow)(int16_t * values, const int16_t * row, int length);
+            // values[i] -= row[i]
+            void (*subtractRow)(int16_t * values, const int16_t * row, int length);
+            // values[i] += added[i] - removed[i], moving a piece in one pass over the accumulator.
+            void (*addSubtractRow)(int16_t * values, const int16_t * added, const int16_t * removed, int length);
+            // output[i] = clamp(input[i], 0, 127)
+            void (*clippedRelu)(const int16_t * input, uint8_t * output, int length);
+            // Returns the sum of input[i] * weights[i]. The inputs must be between 0 and 127 (clipped relu outputs).
+            int32_t (*dot)(const uint8_t * input, const int8_t * weights, int length);
+            // bytes[i] = bit i of bits, for the 64 squares of a bitboard.
+            void (*expandBits)(uint64_t bits, uint8_t * bytes);
+            // values[i] = bit i of bits as 0.0f or 1.0f.
+            void (*expandBitsFloat)(uint64_t bits, float * values);
+        };
+
+        // Returns the fastest level the cpu supports.
+        Level detectLevel();
+        // Returns true if the cpu supports a level.
+        bool supported(Level level);
+
+        // Returns the kernels of a level, the level must be supported.
+        const Kernels& kernels(Level level);
+        // Returns the kernels the network uses, the fastest supported ones unless setLevel was called.
+        const Kernels& kernels();
+        // Selects the kernels the network uses, returns false when the cpu does not support the level.
+        bool setLevel(Level level);
+    }
+}
+
+#endif
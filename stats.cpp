@@ -0,0 +1,80 @@
+// Stats.cpp | Aggregation and output of search statistics.
+
+#include <stats.h>
+#include <sstream>
+
+using namespace nnchesslib;
+
+double SearchStats::ttHitRate() const
+{
+    return ttProbes ? (double)ttHits / ttProbes : 0;
+}
+
+double SearchStats::firstMoveCutoffRate() const
+{
+    return betaCutoffs ? (double)firstMoveCutoffs / betaCutoffs : 0;
+}
+
+double SearchStats::averageReduction() const
+{
+    return reducedMoves ? (double)reductionPlies / reducedMoves : 0;
+}
+
+double SearchStats::pawnHitRate() const
+{
+    return pawnProbes ? (double)pawnHits / pawnProbes : 0;
+}
+
+void ThreadStats::reset()
+{
+    startTime = std::chrono::steady_clock::now();
+    for(StatCounter * counter : {&nodes, &qnodes, &ttProbes, &ttHits, &ttCutoffs, &betaCutoffs, &firstMoveCutoffs,
+        &reducedMoves, &reductionPlies, &previousIterationNodes, &lastIterationNodes})
+        counter->set(0);
+}
+
+void SearchStats::add(const ThreadStats& thread)
+{
+    U64 threadNodes = thread.nodes.get() + thread.qnodes.get();
+
+    nodes += thread.nodes.get();
+    qnodes += thread.qnodes.get();
+    ttProbes += thread.ttProbes.get();
+    ttHits += thread.ttHits.get();
+    ttCutoffs += thread.ttCutoffs.get();
+    betaCutoffs += thread.betaCutoffs.get();
+    firstMoveCutoffs += thread.firstMoveCutoffs.get();
+    reducedMoves += thread.reducedMoves.get();
+    reductionPlies += thread.reductionPlies.get();
+
+    // the main thread is added first, its iterations decide the branching factor.
+    if(threadNps.empty() && thread.previousIterationNodes.get())
+        effectiveBranchingFactor = (double)thread.lastIterationNodes.get() / thread.previousIterationNodes.get();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - thread.startTime).count();
+    threadNps.push_back(seconds > 0 ? (U64)(threadNodes / seconds) : 0);
+}
+
+std::string SearchStats::toJson() const
+{
+    std::ostringstream json;
+    json << "{\"nodes\": " << nodes
+         << ", \"qnodes\": " << qnodes
+         << ", \"ttProbes\": " << ttProbes
+         << ", \"ttHits\": " << ttHits
+         << ", \"ttHitRate\": " << ttHitRate()
+         << ", \"ttCutoffs\": " << ttCutoffs
+         << ", \"betaCutoffs\": " << betaCutoffs
+         << ", \"firstMoveCutoffRate\": " << firstMoveCutoffRate()
+         << ", \"effectiveBranchingFactor\": " << effectiveBranchingFactor
+         << ", \"reducedMoves\": " << reducedMoves
+         << ", \"averageReduction\": " << averageReduction()
+         << ", \"pawnHitRate\": " << pawnHitRate()
+         << ", \"threadNps\": [";
+
+    for(size_t i = 0; i < threadNps.size(); i++)
+        json << (i ? ", " : "") << threadNps[i];
+
+    json << "]}";
+    return json.str();
+}
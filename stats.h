@@ -0,0 +1,93 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <types.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Search statistics are only collected in builds with SEARCH_STATS defined (make stats). In other builds
+// SEARCH_STAT(...) expands to nothing, so the search does not pay for them.
+#ifdef SEARCH_STATS
+#define SEARCH_STAT(statement) statement
+#else
+#define SEARCH_STAT(statement)
+#endif
+
+namespace nnchesslib
+{
+    // A counter that is only changed by its own search thread, but can be read by any thread at any time.
+    // a relaxed load and store compile to plain instructions, unlike a locked fetch_add.
+    struct StatCounter
+    {
+        std::atomic<U64> value{0};
+
+        inline void add(U64 amount = 1) { value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+        inline void set(U64 amount) { value.store(amount, std::memory_order_relaxed); }
+        inline U64 get() const { return value.load(std::memory_order_relaxed); }
+    };
+
+    // Counters of a single search thread.
+    struct ThreadStats
+    {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+        // Nodes of the main search and of the quiescence search.
+        StatCounter nodes;
+        StatCounter qnodes;
+
+        StatCounter ttProbes;
+        StatCounter ttHits;
+        // Probes that ended the search of a node right away.
+        StatCounter ttCutoffs;
+
+        StatCounter betaCutoffs;
+        // Beta cutoffs caused by the first move searched, a measure of the move ordering.
+        StatCounter firstMoveCutoffs;
+
+        // Moves searched with a late move reduction, and the sum of their reductions.
+        StatCounter reducedMoves;
+        StatCounter reductionPlies;
+
+        // Nodes of the last two completed iterations, for the effective branching factor.
+        StatCounter previousIterationNodes;
+        StatCounter lastIterationNodes;
+
+        // Sets all counters to 0 and restarts the clock, for a thread that starts a new search.
+        void reset();
+    };
+
+    // Statistics of all threads of a search added together.
+    struct SearchStats
+    {
+        U64 nodes = 0;
+        U64 qnodes = 0;
+        U64 ttProbes = 0;
+        U64 ttHits = 0;
+        U64 ttCutoffs = 0;
+        U64 betaCutoffs = 0;
+        U64 firstMoveCutoffs = 0;
+        U64 reducedMoves = 0;
+        U64 reductionPlies = 0;
+        U64 pawnProbes = 0;
+        U64 pawnHits = 0;
+
+        // Nodes of an iteration divided by the nodes of the iteration before it.
+        double effectiveBranchingFactor = 0;
+        // Nodes per second of every thread, the main thread first.
+        std::vector<U64> threadNps;
+
+        double ttHitRate() const;
+        double firstMoveCutoffRate() const;
+        double averageReduction() const;
+        double pawnHitRate() const;
+
+        // Adds the current values of one thread, it may still be searching.
+        void add(const ThreadStats& thread);
+
+        std::string toJson() const;
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+// Tensor.cpp | Dense board tensors for convolutional networks.
+
+#include <tensor.h>
+#include <board.h>
+#include <simd.h>
+
+using namespace nnchesslib;
+
+size_t Tensor::BoardBatch::size() const
+{
+    return flags.size();
+}
+
+void Tensor::BoardBatch::reserve(size_t count)
+{
+    whitePieces.reserve(count);
+    blackPieces.reserve(count);
+    for(std::vector<U64> &boards : pieces)
+        boards.reserve(count);
+    flags.reserve(count);
+    enPassant.reserve(count);
+}
+
+void Tensor::BoardBatch::clear()
+{
+    whitePieces.clear();
+    blackPieces.clear();
+    for(std::vector<U64> &boards : pieces)
+        boards.clear();
+    flags.clear();
+    enPassant.clear();
+}
+
+void Tensor::BoardBatch::add(const BoardInfo& info)
+{
+    whitePieces.push_back(info.whitePieces.board);
+    blackPieces.push_back(info.blackPieces.board);
+    const BitBoard pieceBoards[6] = {info.pawns, info.knights, info.bishops, info.rooks, info.queens, info.kings};
+    for(int piece = PAWN; piece <= KING; piece++)
+        pieces[piece].push_back(pieceBoards[piece].board);
+
+    flags.push_back(info.whiteToMove | info.whiteCastleShort << 1 | info.whiteCastleLong << 2
+                  | info.blackCastleShort << 3 | info.blackCastleLong << 4);
+    BitBoard target = info.whiteEnPassantTarget | info.blackEnPassantTarget;
+    enPassant.push_back(target ? target.lsb() : 64);
+}
+
+void Tensor::BoardBatch::add(const Features::PackedPosition& position)
+{
+    add(Features::unpackPieces(position));
+}
+
+size_t Tensor::tensorSize(const BoardBatch& batch)
+{
+    return batch.size() * PLANES * 64;
+}
+
+// Computes the planes of one position as bitboards, so every plane is expanded the same way.
+static void planeBoards(const Tensor::BoardBatch& batch, size_t i, Tensor::Orientation orientation, U64 planes[Tensor::PLANES])
+{
+    bool whiteToMove = batch.flags[i] & 1;
+    bool flip = orientation == Tensor::SIDE_TO_MOVE_VIEW && !whiteToMove;
+
+    // flipping a bitboard vertically reverses its bytes.
+    auto oriented = [flip](U64 bits) { return flip ? __builtin_bswap64(bits) : bits; };
+
+    U64 first = flip ? batch.blackPieces[i] : batch.whitePieces[i];
+    U64 second = flip ? batch.whitePieces[i] : batch.blackPieces[i];
+    for(int piece = PAWN; piece <= KING; piece++)
+    {
+        planes[piece] = oriented(batch.pieces[piece][i] & first);
+        planes[6 + piece] = oriented(batch.pieces[piece][i] & second);
+    }
+
+    planes[Tensor::SIDE_TO_MOVE_PLANE] = whiteToMove ? ~(U64)0 : 0;
+
+    // white's rights are bits 1 and 2, black's bits 3 and 4.
+    int castling = batch.flags[i] >> 1;
+    if(flip) castling = (castling >> 2) | (castling & 3) << 2;
+    for(int right = 0; right < 4; right++)
+        planes[Tensor::CASTLING_PLANE + right] = castling >> right & 1 ? ~(U64)0 : 0;
+
+    planes[Tensor::EN_PASSANT_PLANE] = batch.enPassant[i] < 64 ? oriented((U64)1 << batch.enPassant[i]) : 0;
+}
+
+void Tensor::encode(const BoardBatch& batch, uint8_t * tensor, Orientation orientation)
+{
+    const Simd::Kernels& kernels = Simd::kernels();
+    U64 planes[PLANES];
+
+    for(size_t i = 0; i < batch.size(); i++)
+    {
+        planeBoards(batch, i, orientation, planes);
+        for(int plane = 0; plane < PLANES; plane++)
+            kernels.expandBits(planes[plane], tensor + (i * PLANES + plane) * 64);
+    }
+}
+
+void Tensor::encode(const BoardBatch& batch, float * tensor, Orientation orientation)
+{
+    const Simd::Kernels& kernels = Simd::kernels();
+    U64 planes[PLANES];
+
+    for(size_t i = 0; i < batch.size(); i++)
+    {
+        planeBoards(batch, i, orientation, planes);
+        for(int plane = 0; plane < PLANES; plane++)
+            kernels.expandBitsFloat(planes[plane], tensor + (i * PLANES + plane) * 64);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef TENSOR_H
+#define TENSOR_H
+
+#include <types.h>
+#include <featureset.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nnchesslib
+{
+    struct BoardInfo;
+
+    namespace Tensor
+    {
+        // Planes of 8x8 per position: 12 piece planes (pawn to king, the first side's pieces then the other's),
+        // side to move, the four castling rights (short and long of the first side, then the other's) and en passant.
+        const int PIECE_PLANES = 12;
+        const int SIDE_TO_MOVE_PLANE = 12;
+        const int CASTLING_PLANE = 13;
+        const int EN_PASSANT_PLANE = 17;
+        const int PLANES = 18;
+
+        // WHITE_VIEW encodes every position as it is, with white first. SIDE_TO_MOVE_VIEW flips positions with black
+        // to move, so the side to move is always first and plays up the board, as networks usually expect.
+        enum Orientation
+        {
+            WHITE_VIEW, SIDE_TO_MOVE_VIEW
+        };
+
+        // Structure of arrays of positions, so the encoder reads each kind of bitboard as one contiguous array.
+        struct BoardBatch
+        {
+            std::vector<U64> whitePieces;
+            std::vector<U64> blackPieces;
+            // Indexed by PieceType, pawns to kings.
+            std::vector<U64> pieces[6];
+            // Bit 0 is set when white is to move, bits 1-4 are the castling rights K, Q, k and q.
+            std::vector<uint8_t> flags;
+            // En passant target square, 64 when there is none.
+            std::vector<uint8_t> enPassant;
+
+            size_t size() const;
+            void reserve(size_t count);
+            void clear();
+            void add(const BoardInfo& info);
+            void add(const Features::PackedPosition& position);
+        };
+
+        // Returns the number of values encode writes for a batch, positions * PLANES * 64.
+        size_t tensorSize(const BoardBatch& batch);
+
+        // Encodes a batch into an NCHW tensor of 0 and 1 values (N positions, C planes, 8 ranks, 8 files), rank 1 first.
+        void encode(const BoardBatch& batch, uint8_t * tensor, Orientation orientation = SIDE_TO_MOVE_VIEW);
+        void encode(const BoardBatch& batch, float * tensor, Orientation orientation = SIDE_TO_MOVE_VIEW);
+    }
+}
+
+#endif
@@ -0,0 +1,40 @@
+// Timeman.cpp | Time allocation for a search.
+
+#include <timeman.h>
+#include <search.h>
+#include <algorithm>
+
+using namespace nnchesslib;
+
+void TimeManager::init(const SearchLimits& limits, Color us)
+{
+    startTime = std::chrono::steady_clock::now();
+
+    int64_t time = us == WHITE ? limits.wtime : limits.btime;
+    int64_t increment = us == WHITE ? limits.winc : limits.binc;
+
+    enabled = limits.movetime > 0 || time > 0;
+    if(!enabled) return;
+
+    // a fixed time per move is used completely, there is nothing to save it for.
+    if(limits.movetime > 0)
+    {
+        optimumTime = maximumTime = std::max<int64_t>(1, limits.movetime - limits.moveOverhead);
+        return;
+    }
+
+    // without a number of moves until the next time control, the game is assumed to last about 30 more moves.
+    int movesToGo = limits.movestogo > 0 ? std::min(limits.movestogo, 50) : 30;
+    int64_t available = std::max<int64_t>(1, time - limits.moveOverhead);
+
+    optimumTime = available / movesToGo + increment * 3 / 4;
+    // an unstable best move may use several times the optimum, but never most of the clock.
+    maximumTime = std::min(optimumTime * 5, available * 4 / 5);
+    optimumTime = std::max<int64_t>(1, std::min(optimumTime, maximumTime));
+    maximumTime = std::max(optimumTime, maximumTime);
+}
+
+int64_t TimeManager::elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
@@ -0,0 +1,33 @@
+#ifndef TIMEMAN_H
+#define TIMEMAN_H
+
+#include <types.h>
+#include <chrono>
+#include <cstdint>
+
+namespace nnchesslib
+{
+    struct SearchLimits;
+
+    // Decides how long a search may take, from the clock state or a fixed time per move.
+    class TimeManager
+    {
+        public:
+            std::chrono::steady_clock::time_point startTime;
+
+            // False when the search has no time limit at all.
+            bool enabled = false;
+            // Time after which no new iteration is started, it is scaled by how stable the best move is.
+            int64_t optimumTime = 0;
+            // Hard limit, the search is stopped in the middle of an iteration when it is reached.
+            int64_t maximumTime = 0;
+
+            // Calculates the time budget of a search for the given side that starts now.
+            void init(const SearchLimits& limits, Color us);
+
+            // Milliseconds since the search started.
+            int64_t elapsed() const;
+    };
+}
+
+#endif
@@ -0,0 +1,157 @@
+// Tt.cpp | Lock-free transposition table shared between search threads.
+
+#include <tt.h>
+#include <types.h>
+#include <move.h>
+#include <cstring>
+#include <algorithm>
+
+using namespace nnchesslib;
+
+TranspositionTable nnchesslib::TT;
+
+// data layout: 0-15 move, 16-31 score, 32-47 eval, 48-55 depth, 56-57 bound, 58-63 generation.
+U64 TranspositionTable::pack(TTData data, uint8_t generation)
+{
+    return (U64)data.move
+         | (U64)(uint16_t)data.score << 16
+         | (U64)(uint16_t)data.eval << 32
+         | (U64)(uint8_t)data.depth << 48
+         | (U64)data.bound << 56
+         | (U64)(generation & 63) << 58;
+}
+
+TTData TranspositionTable::unpack(U64 data)
+{
+    TTData output;
+    output.move = Move(data & 0xFFFF);
+    output.score = (int16_t)((data >> 16) & 0xFFFF);
+    output.eval = (int16_t)((data >> 32) & 0xFFFF);
+    output.depth = (uint8_t)((data >> 48) & 0xFF);
+    output.bound = Bound((data >> 56) & 3);
+    return output;
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    clusterCount = std::max((U64)1, (U64)megabytes * 1024 * 1024 / sizeof(TTCluster));
+    clusters.reset(new TTCluster[clusterCount]);
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for(U64 i = 0; i < clusterCount; i++)
+    {
+        for(TTEntry &entry : clusters[i].entries)
+        {
+            entry.keyXorData.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::empty()
+{
+    return clusterCount == 0;
+}
+
+void TranspositionTable::newSearch()
+{
+    generation = (generation + 1) & 63;
+}
+
+TTCluster * TranspositionTable::getCluster(U64 key)
+{
+    // multiplying by the cluster count maps the key onto [0, clusterCount) without a modulo.
+    return &clusters[(U64)(((unsigned __int128)key * clusterCount) >> 64)];
+}
+
+void TranspositionTable::prefetch(U64 key)
+{
+    if(clusterCount)
+        __builtin_prefetch(getCluster(key));
+}
+
+bool TranspositionTable::probe(U64 key, TTData &data)
+{
+    if(!clusterCount) return false;
+
+    TTCluster * cluster = getCluster(key);
+
+    for(TTEntry &entry : cluster->entries)
+    {
+        U64 entryData = entry.data.load(std::memory_order_relaxed);
+        U64 keyXorData = entry.keyXorData.load(std::memory_order_relaxed);
+
+        if((keyXorData ^ entryData) == key && entryData)
+        {
+            data = unpack(entryData);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(U64 key, Move move, int score, int eval, int depth, Bound bound)
+{
+    if(!clusterCount) return;
+
+    TTCluster * cluster = getCluster(key);
+    TTEntry * replace = &cluster->entries[0];
+    int replaceValue = 1 << 30;
+
+    for(TTEntry &entry : cluster->entries)
+    {
+        U64 entryData = entry.data.load(std::memory_order_relaxed);
+        U64 keyXorData = entry.keyXorData.load(std::memory_order_relaxed);
+
+        // the same position is always overwritten, but a known best move is kept when the new result has none.
+        if((keyXorData ^ entryData) == key)
+        {
+            if(move == MOVE_NONE)
+                move = unpack(entryData).move;
+            replace = &entry;
+            break;
+        }
+
+        // otherwise the entry with the lowest depth is replaced, where every search of age counts as 8 plies.
+        int entryDepth = (entryData >> 48) & 0xFF;
+        int age = (generation - (int)(entryData >> 58)) & 63;
+        int value = entryDepth - 8 * age;
+        if(value < replaceValue)
+        {
+            replaceValue = value;
+            replace = &entry;
+        }
+    }
+
+    TTData data;
+    data.move = move;
+    data.score = score;
+    data.eval = eval;
+    data.depth = std::max(0, depth);
+    data.bound = bound;
+
+    U64 packed = pack(data, generation);
+    replace->keyXorData.store(key ^ packed, std::memory_order_relaxed);
+    replace->data.store(packed, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull()
+{
+    U64 samples = std::min((U64)1000 / TTCluster::ENTRIES, clusterCount);
+    if(!samples) return 0;
+
+    int used = 0;
+    for(U64 i = 0; i < samples; i++)
+    {
+        for(TTEntry &entry : clusters[i].entries)
+        {
+            U64 entryData = entry.data.load(std::memory_order_relaxed);
+            if(entryData && (entryData >> 58) == generation) used++;
+        }
+    }
+    return used * 1000 / (samples * TTCluster::ENTRIES);
+}
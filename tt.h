@@ -0,0 +1,79 @@
+#ifndef TT_H
+#define TT_H
+
+#include <types.h>
+#include <move.h>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace nnchesslib
+{
+    enum Bound
+    {
+        BOUND_NONE, BOUND_UPPER, BOUND_LOWER, BOUND_EXACT = BOUND_UPPER | BOUND_LOWER
+    };
+
+    // Decoded contents of a transposition table entry.
+    struct TTData
+    {
+        Move move = MOVE_NONE;
+        int score = 0;
+        int eval = 0;
+        int depth = 0;
+        Bound bound = BOUND_NONE;
+    };
+
+    // Entries are stored as (key ^ data, data). A torn write by another thread makes the xor check fail,
+    // so entries can be read and written by many threads at once without locks.
+    struct TTEntry
+    {
+        std::atomic<U64> keyXorData;
+        std::atomic<U64> data;
+    };
+
+    // Four entries fill exactly one 64 byte cache line, so probing a bucket costs a single cache miss.
+    struct alignas(64) TTCluster
+    {
+        static const int ENTRIES = 4;
+        TTEntry entries[ENTRIES];
+    };
+
+    class TranspositionTable
+    {
+        private:
+            std::unique_ptr<TTCluster[]> clusters;
+            U64 clusterCount = 0;
+            uint8_t generation = 0;
+
+            static U64 pack(TTData data, uint8_t generation);
+            static TTData unpack(U64 data);
+
+        public:
+            // Allocates a table of the given size in megabytes, clearing all entries.
+            void resize(size_t megabytes);
+            void clear();
+            bool empty();
+
+            // Called at the start of every search, entries from older searches are replaced first.
+            void newSearch();
+
+            // Returns the bucket a key maps to.
+            TTCluster * getCluster(U64 key);
+            // Starts loading the bucket of a key into the cache before it is probed.
+            void prefetch(U64 key);
+
+            // Looks up a position, returns true and fills data when it is found.
+            bool probe(U64 key, TTData &data);
+            // Stores a position, replacing the shallowest or oldest entry of its bucket.
+            void store(U64 key, Move move, int score, int eval, int depth, Bound bound);
+
+            // Permille of the table used by the current search, sampled from the first 1000 entries (250 buckets).
+            int hashfull();
+    };
+
+    // Transposition table shared by all search threads.
+    extern TranspositionTable TT;
+}
+
+#endif
@@ -6,11 +6,23 @@
 
 namespace nnchesslib{
 
-    int countBits(U64 n);
+    // counts 1's in a U64
+    constexpr inline int countBits(U64 n)
+    {
+        return __builtin_popcountll(n);
+    }
 
-    int bitScanForward(U64 board);
+    // returns the index of the least significant bit or -1 for an empty board.
+    constexpr inline int bitScanForward(U64 board)
+    {
+        return __builtin_ffsll(board) - 1;
+    }
 
-    int bitScanReverse(U64 board);
+    // returns the index of the most significant bit, the board must not be empty.
+    constexpr inline int bitScanReverse(U64 board)
+    {
+        return 63 - __builtin_clzll(board);
+    }
 
     int getSquareInt(std::string square);
     std::string getSquareString(int square);
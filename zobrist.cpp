@@ -0,0 +1,38 @@
+// Zobrist.cpp | Random keys used to incrementally hash positions.
+
+#include <types.h>
+#include <zobrist.h>
+
+using namespace nnchesslib;
+
+U64 Zobrist::pieceKeys[2][6][64];
+U64 Zobrist::castlingKeys[4];
+U64 Zobrist::enPassantKeys[8];
+U64 Zobrist::sideKey;
+
+// xorshift64* with a fixed seed, so keys are the same in every run.
+static U64 randomKey(U64 &state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+void Zobrist::initKeys()
+{
+    U64 state = 0x9E3779B97F4A7C15ULL;
+
+    for(int c = 0; c < 2; c++)
+        for(int p = 0; p < 6; p++)
+            for(int sq = 0; sq < 64; sq++)
+                pieceKeys[c][p][sq] = randomKey(state);
+
+    for(int i = 0; i < 4; i++)
+        castlingKeys[i] = randomKey(state);
+
+    for(int f = 0; f < 8; f++)
+        enPassantKeys[f] = randomKey(state);
+
+    sideKey = randomKey(state);
+}
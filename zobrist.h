@@ -0,0 +1,20 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <types.h>
+
+namespace nnchesslib
+{
+    namespace Zobrist
+    {
+        extern U64 pieceKeys[2][6][64];
+        // white short, white long, black short, black long.
+        extern U64 castlingKeys[4];
+        extern U64 enPassantKeys[8];
+        extern U64 sideKey;
+
+        void initKeys();
+    }
+}
+
+#endif